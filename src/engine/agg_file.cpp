@@ -18,60 +18,154 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
+#include <algorithm>
 #include <string>
 
 #include "agg_file.h"
+#include "tools.h"
 
 namespace fheroes2
 {
     bool AGGFile::isGood() const
     {
+#if defined( FHEROES2_VITA ) || defined( __SWITCH__ )
         return !_stream.fail() && !_files.empty();
+#else
+        return _file.isOpen() && !_files.empty();
+#endif
     }
 
+#if defined( FHEROES2_VITA ) || defined( __SWITCH__ )
     bool AGGFile::open( const std::string & fileName )
     {
+        _files.clear();
+
         if ( !_stream.open( fileName, "rb" ) )
             return false;
 
         const size_t size = _stream.size();
-        const size_t count = _stream.getLE16();
+        const size_t count = size < sizeof( uint16_t ) ? 0 : _stream.getLE16();
         const size_t fileRecordSize = sizeof( uint32_t ) * 3;
 
-        if ( count * ( fileRecordSize + _maxFilenameSize ) >= size )
+        if ( count == 0 || count * ( fileRecordSize + _maxFilenameSize ) >= size ) {
+            _stream.close();
             return false;
+        }
 
-        StreamBuf fileEntries = _stream.toStreamBuf( count * fileRecordSize );
+        const std::vector<uint8_t> fileEntries = _stream.getRaw( count * fileRecordSize );
         const size_t nameEntriesSize = _maxFilenameSize * count;
         _stream.seek( size - nameEntriesSize );
-        StreamBuf nameEntries = _stream.toStreamBuf( nameEntriesSize );
+        const std::vector<uint8_t> nameEntries = _stream.getRaw( nameEntriesSize );
 
-        for ( size_t i = 0; i < count; ++i ) {
-            const std::string & name = nameEntries.toString( _maxFilenameSize );
-            fileEntries.getLE32(); // skip CRC (?) part
-            const uint32_t fileOffset = fileEntries.getLE32();
-            const uint32_t fileSize = fileEntries.getLE32();
-            _files.emplace( name, std::make_pair( fileSize, fileOffset ) );
+        if ( _stream.fail() || !_readTable( fileEntries.data(), reinterpret_cast<const char *>( nameEntries.data() ), count, size ) ) {
+            _stream.close();
+            return false;
         }
-        if ( _files.size() != count ) {
-            _files.clear();
+
+        return true;
+    }
+
+    AGGFile::FileView AGGFile::view( const std::string & fileName ) const
+    {
+        const auto it = std::lower_bound( _files.begin(), _files.end(), fileName,
+                                          []( const FileEntry & entry, const std::string & name ) { return entry.name < name; } );
+        if ( it == _files.end() || it->name != fileName || it->size == 0 ) {
+            return FileView();
+        }
+
+        std::lock_guard<std::mutex> guard( _mutex );
+
+        _stream.seek( it->offset );
+        return FileView( std::make_shared<const std::vector<uint8_t>>( _stream.getRaw( it->size ) ) );
+    }
+#else
+    bool AGGFile::open( const std::string & fileName )
+    {
+        _files.clear();
+
+        if ( !_file.open( fileName ) )
+            return false;
+
+        const size_t size = _file.size();
+        if ( size < sizeof( uint16_t ) ) {
+            _file.close();
+            return false;
+        }
+
+        StreamBuf header( _file.data(), size );
+        const size_t count = header.getLE16();
+        const size_t fileRecordSize = sizeof( uint32_t ) * 3;
+
+        if ( count * ( fileRecordSize + _maxFilenameSize ) >= size ) {
+            _file.close();
             return false;
         }
-        return !_stream.fail();
+
+        const char * nameEntries = reinterpret_cast<const char *>( _file.data() + size - _maxFilenameSize * count );
+        if ( !_readTable( _file.data() + sizeof( uint16_t ), nameEntries, count, size ) ) {
+            _file.close();
+            return false;
+        }
+
+        return true;
+    }
+
+    AGGFile::FileView AGGFile::view( const std::string & fileName ) const
+    {
+        const auto it = std::lower_bound( _files.begin(), _files.end(), fileName,
+                                          []( const FileEntry & entry, const std::string & name ) { return entry.name < name; } );
+        if ( it == _files.end() || it->name != fileName || it->size == 0 ) {
+            return FileView();
+        }
+
+        return FileView( _file.data() + it->offset, it->size );
+    }
+#endif
+
+    std::vector<uint8_t> AGGFile::read( const std::string & fileName ) const
+    {
+        const FileView file = view( fileName );
+        return std::vector<uint8_t>( file.data, file.data + file.size );
     }
 
-    std::vector<uint8_t> AGGFile::read( const std::string & fileName )
+    bool AGGFile::_readTable( const uint8_t * fileEntries, const char * nameEntries, const size_t count, const size_t size )
     {
-        auto it = _files.find( fileName );
-        if ( it != _files.end() ) {
-            const auto & fileParams = it->second;
-            if ( fileParams.first > 0 ) {
-                _stream.seek( fileParams.second );
-                return _stream.getRaw( fileParams.first );
+        const size_t fileRecordSize = sizeof( uint32_t ) * 3;
+        const size_t nameEntriesSize = _maxFilenameSize * count;
+
+        // File entries contain checksums of the files so any change of the content changes the checksum of the table.
+        _checksum = calculateCRC32( fileEntries, count * fileRecordSize ) ^ calculateCRC32( reinterpret_cast<const uint8_t *>( nameEntries ), nameEntriesSize )
+                    ^ static_cast<uint32_t>( size );
+
+        StreamBuf fileRecords( fileEntries, count * fileRecordSize );
+
+        _files.resize( count );
+
+        for ( size_t i = 0; i < count; ++i ) {
+            const char * name = nameEntries + i * _maxFilenameSize;
+            FileEntry & entry = _files[i];
+
+            entry.name.assign( name, std::find( name, name + _maxFilenameSize, '\0' ) );
+            fileRecords.getLE32(); // skip CRC (?) part
+            entry.offset = fileRecords.getLE32();
+            entry.size = fileRecords.getLE32();
+
+            if ( static_cast<uint64_t>( entry.offset ) + entry.size > size ) {
+                _files.clear();
+                return false;
             }
         }
 
-        return std::vector<uint8_t>();
+        std::sort( _files.begin(), _files.end(), []( const FileEntry & left, const FileEntry & right ) { return left.name < right.name; } );
+
+        const auto duplicate
+            = std::adjacent_find( _files.begin(), _files.end(), []( const FileEntry & left, const FileEntry & right ) { return left.name == right.name; } );
+        if ( duplicate != _files.end() ) {
+            _files.clear();
+            return false;
+        }
+
+        return true;
     }
 }
 
@@ -21,17 +21,53 @@
 #ifndef AGG_FILE_H
 #define AGG_FILE_H
 
-#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
+#if defined( FHEROES2_VITA ) || defined( __SWITCH__ )
+#include <mutex>
+#else
+#include "memory_mapped_file.h"
+#endif
 #include "serialize.h"
 
 namespace fheroes2
 {
+    // AGG file is mapped into memory and never modified after opening so the same object can be read by several threads at the same time.
+    // On platforms without memory mapping every file is read from the stream on request instead.
     class AGGFile
     {
     public:
+        // Read-only content of a file stored in AGG file. It is valid while the AGG file is open.
+        struct FileView
+        {
+            FileView() = default;
+
+            FileView( const uint8_t * data_, const size_t size_ )
+                : data( data_ )
+                , size( size_ )
+            {}
+
+            // The view owns the content read from the stream.
+            explicit FileView( std::shared_ptr<const std::vector<uint8_t>> buffer )
+                : data( buffer->data() )
+                , size( buffer->size() )
+                , _buffer( std::move( buffer ) )
+            {}
+
+            bool empty() const
+            {
+                return size == 0;
+            }
+
+            const uint8_t * data = nullptr;
+            size_t size = 0;
+
+        private:
+            std::shared_ptr<const std::vector<uint8_t>> _buffer;
+        };
+
         AGGFile()
         {
             // Avoid C4592 warning in Visual Studio.
@@ -39,13 +75,39 @@ namespace fheroes2
 
         bool isGood() const;
         bool open( const std::string & fileName );
-        std::vector<uint8_t> read( const std::string & fileName );
+
+        // Returns an empty view if there is no such file.
+        FileView view( const std::string & fileName ) const;
+
+        // Same as view() but returns a copy of the file content.
+        std::vector<uint8_t> read( const std::string & fileName ) const;
+
+        // Checksum of the file table, it is different for files with different content.
+        uint32_t checksum() const
+        {
+            return _checksum;
+        }
 
     private:
         static const size_t _maxFilenameSize = 15; // 8.3 ASCIIZ file name + 2-bytes padding
 
-        StreamFile _stream;
-        std::map<std::string, std::pair<uint32_t, uint32_t> > _files;
+        struct FileEntry
+        {
+            std::string name;
+            uint32_t offset;
+            uint32_t size;
+        };
+
+#if defined( FHEROES2_VITA ) || defined( __SWITCH__ )
+        mutable StreamFile _stream;
+        mutable std::mutex _mutex;
+#else
+        MemoryMappedFile _file;
+#endif
+        std::vector<FileEntry> _files; // sorted by name
+        uint32_t _checksum = 0;
+
+        bool _readTable( const uint8_t * fileEntries, const char * nameEntries, const size_t count, const size_t size );
     };
 
     struct ICNHeader
@@ -25,6 +25,14 @@
 #include <cstdlib>
 #include <cstring>
 
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define FHEROES2_IMAGE_SSE2
+#include <emmintrin.h>
+#elif defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+#define FHEROES2_IMAGE_NEON
+#include <arm_neon.h>
+#endif
+
 namespace
 {
     // 0 in shadow part means no shadow, 1 means skip any drawings so to don't waste extra CPU cycles for ( tableId - 2 ) command we just add extra fake tables
@@ -365,6 +373,296 @@ namespace
         return rgbToId[red + green * 64 + blue * 64 * 64];
     }
 
+    bool isVectorizationEnabled = true;
+
+#if defined( FHEROES2_IMAGE_SSE2 ) || defined( FHEROES2_IMAGE_NEON )
+    // Rows are processed by blocks of 16 pixels. A block where every pixel is either copied or skipped is handled by vector instructions,
+    // a block with at least one pixel requiring a lookup in a transform table or a palette is passed to scalar code.
+    const int32_t blockSize = 16;
+
+#if defined( FHEROES2_IMAGE_SSE2 )
+    using PixelBlock = __m128i;
+
+    PixelBlock loadBlock( const uint8_t * data )
+    {
+        return _mm_loadu_si128( reinterpret_cast<const __m128i *>( data ) );
+    }
+
+    void storeBlock( uint8_t * data, const PixelBlock block )
+    {
+        _mm_storeu_si128( reinterpret_cast<__m128i *>( data ), block );
+    }
+
+    PixelBlock equalMask( const PixelBlock block, const uint8_t value )
+    {
+        return _mm_cmpeq_epi8( block, _mm_set1_epi8( static_cast<char>( value ) ) );
+    }
+
+    PixelBlock orMask( const PixelBlock first, const PixelBlock second )
+    {
+        return _mm_or_si128( first, second );
+    }
+
+    // Returns the mask with bits of the first mask cleared from the second one.
+    PixelBlock excludeMask( const PixelBlock first, const PixelBlock second )
+    {
+        return _mm_andnot_si128( first, second );
+    }
+
+    // Takes pixels from the first block where the mask is set and from the second block otherwise.
+    PixelBlock selectBlock( const PixelBlock mask, const PixelBlock first, const PixelBlock second )
+    {
+        return _mm_or_si128( _mm_and_si128( mask, first ), _mm_andnot_si128( mask, second ) );
+    }
+
+    bool isMaskFull( const PixelBlock mask )
+    {
+        return _mm_movemask_epi8( mask ) == 0xFFFF;
+    }
+
+    bool isMaskEmpty( const PixelBlock mask )
+    {
+        return _mm_movemask_epi8( mask ) == 0;
+    }
+#else
+    using PixelBlock = uint8x16_t;
+
+    PixelBlock loadBlock( const uint8_t * data )
+    {
+        return vld1q_u8( data );
+    }
+
+    void storeBlock( uint8_t * data, const PixelBlock block )
+    {
+        vst1q_u8( data, block );
+    }
+
+    PixelBlock equalMask( const PixelBlock block, const uint8_t value )
+    {
+        return vceqq_u8( block, vdupq_n_u8( value ) );
+    }
+
+    PixelBlock orMask( const PixelBlock first, const PixelBlock second )
+    {
+        return vorrq_u8( first, second );
+    }
+
+    // Returns the mask with bits of the first mask cleared from the second one.
+    PixelBlock excludeMask( const PixelBlock first, const PixelBlock second )
+    {
+        return vbicq_u8( second, first );
+    }
+
+    // Takes pixels from the first block where the mask is set and from the second block otherwise.
+    PixelBlock selectBlock( const PixelBlock mask, const PixelBlock first, const PixelBlock second )
+    {
+        return vbslq_u8( mask, first, second );
+    }
+
+    bool isMaskFull( const PixelBlock mask )
+    {
+        const uint8x8_t half = vand_u8( vget_low_u8( mask ), vget_high_u8( mask ) );
+        return vget_lane_u64( vreinterpret_u64_u8( half ), 0 ) == UINT64_MAX;
+    }
+
+    bool isMaskEmpty( const PixelBlock mask )
+    {
+        const uint8x8_t half = vorr_u8( vget_low_u8( mask ), vget_high_u8( mask ) );
+        return vget_lane_u64( vreinterpret_u64_u8( half ), 0 ) == 0;
+    }
+#endif
+
+    bool isBlockFilledWith( const uint8_t * data, const uint8_t value )
+    {
+        return isMaskFull( equalMask( loadBlock( data ), value ) );
+    }
+#endif
+
+    void blitPixelsOnSingleLayer( const uint8_t * imageIn, const uint8_t * transformIn, uint8_t * imageOut, const int32_t count )
+    {
+        const uint8_t * imageInEnd = imageIn + count;
+
+        for ( ; imageIn != imageInEnd; ++imageIn, ++transformIn, ++imageOut ) {
+            if ( *transformIn > 0 ) { // apply a transformation
+                if ( *transformIn != 1 ) { // skip pixel
+                    *imageOut = *( transformTable + ( *transformIn ) * 256 + *imageOut );
+                }
+            }
+            else { // copy a pixel
+                *imageOut = *imageIn;
+            }
+        }
+    }
+
+    void blitRowOnSingleLayer( const uint8_t * imageIn, const uint8_t * transformIn, uint8_t * imageOut, const int32_t width )
+    {
+        int32_t x = 0;
+
+#if defined( FHEROES2_IMAGE_SSE2 ) || defined( FHEROES2_IMAGE_NEON )
+        if ( isVectorizationEnabled ) {
+            for ( ; x + blockSize <= width; x += blockSize ) {
+                const PixelBlock transform = loadBlock( transformIn + x );
+                const PixelBlock copyMask = equalMask( transform, 0 );
+
+                if ( isMaskFull( copyMask ) ) {
+                    storeBlock( imageOut + x, loadBlock( imageIn + x ) );
+                    continue;
+                }
+
+                const PixelBlock skipMask = equalMask( transform, 1 );
+
+                if ( isMaskFull( skipMask ) ) {
+                    continue;
+                }
+
+                if ( isMaskFull( orMask( copyMask, skipMask ) ) ) {
+                    storeBlock( imageOut + x, selectBlock( copyMask, loadBlock( imageIn + x ), loadBlock( imageOut + x ) ) );
+                    continue;
+                }
+
+                blitPixelsOnSingleLayer( imageIn + x, transformIn + x, imageOut + x, blockSize );
+            }
+        }
+#endif
+
+        blitPixelsOnSingleLayer( imageIn + x, transformIn + x, imageOut + x, width - x );
+    }
+
+    void blitPixelsOnDoubleLayer( const uint8_t * imageIn, const uint8_t * transformIn, uint8_t * imageOut, uint8_t * transformOut, const int32_t count )
+    {
+        const uint8_t * imageInEnd = imageIn + count;
+
+        for ( ; imageIn != imageInEnd; ++imageIn, ++transformIn, ++imageOut, ++transformOut ) {
+            if ( *transformIn == 1 ) { // skip pixel
+                continue;
+            }
+
+            if ( *transformIn > 0 && *transformOut == 0 ) { // apply a transformation
+                *imageOut = *( transformTable + ( *transformIn ) * 256 + *imageOut );
+            }
+            else { // copy a pixel
+                *transformOut = *transformIn;
+                *imageOut = *imageIn;
+            }
+        }
+    }
+
+    void blitRowOnDoubleLayer( const uint8_t * imageIn, const uint8_t * transformIn, uint8_t * imageOut, uint8_t * transformOut, const int32_t width )
+    {
+        int32_t x = 0;
+
+#if defined( FHEROES2_IMAGE_SSE2 ) || defined( FHEROES2_IMAGE_NEON )
+        if ( isVectorizationEnabled ) {
+            for ( ; x + blockSize <= width; x += blockSize ) {
+                const PixelBlock inTransform = loadBlock( transformIn + x );
+                const PixelBlock skipMask = equalMask( inTransform, 1 );
+
+                if ( isMaskFull( skipMask ) ) {
+                    continue;
+                }
+
+                const PixelBlock outTransform = loadBlock( transformOut + x );
+
+                // transformation is applied to pixels of the output image which have data
+                const PixelBlock transformMask = excludeMask( orMask( equalMask( inTransform, 0 ), skipMask ), equalMask( outTransform, 0 ) );
+
+                if ( !isMaskEmpty( transformMask ) ) {
+                    blitPixelsOnDoubleLayer( imageIn + x, transformIn + x, imageOut + x, transformOut + x, blockSize );
+                    continue;
+                }
+
+                storeBlock( imageOut + x, selectBlock( skipMask, loadBlock( imageOut + x ), loadBlock( imageIn + x ) ) );
+                storeBlock( transformOut + x, selectBlock( skipMask, outTransform, inTransform ) );
+            }
+        }
+#endif
+
+        blitPixelsOnDoubleLayer( imageIn + x, transformIn + x, imageOut + x, transformOut + x, width - x );
+    }
+
+    void alphaBlitPixels( const uint8_t * imageIn, const uint8_t * transformIn, uint8_t * imageOut, const int32_t count, const uint8_t alphaValue,
+                          const uint8_t * gamePalette )
+    {
+        const uint8_t behindValue = 255 - alphaValue;
+        const uint8_t * imageInEnd = imageIn + count;
+
+        for ( ; imageIn != imageInEnd; ++imageIn, ++transformIn, ++imageOut ) {
+            if ( *transformIn == 1 ) { // skip pixel
+                continue;
+            }
+
+            uint8_t inValue = *imageIn;
+            if ( *transformIn > 1 ) {
+                inValue = *( transformTable + ( *transformIn ) * 256 + *imageOut );
+            }
+
+            const uint8_t * inPAL = gamePalette + inValue * 3;
+            const uint8_t * outPAL = gamePalette + ( *imageOut ) * 3;
+
+            const uint32_t red = static_cast<uint32_t>( *inPAL ) * alphaValue + static_cast<uint32_t>( *outPAL ) * behindValue;
+            const uint32_t green = static_cast<uint32_t>( *( inPAL + 1 ) ) * alphaValue + static_cast<uint32_t>( *( outPAL + 1 ) ) * behindValue;
+            const uint32_t blue = static_cast<uint32_t>( *( inPAL + 2 ) ) * alphaValue + static_cast<uint32_t>( *( outPAL + 2 ) ) * behindValue;
+            *imageOut = GetPALColorId( static_cast<uint8_t>( red / 255 ), static_cast<uint8_t>( green / 255 ), static_cast<uint8_t>( blue / 255 ) );
+        }
+    }
+
+    void alphaBlitRow( const uint8_t * imageIn, const uint8_t * transformIn, uint8_t * imageOut, const int32_t width, const uint8_t alphaValue,
+                       const uint8_t * gamePalette )
+    {
+        int32_t x = 0;
+
+#if defined( FHEROES2_IMAGE_SSE2 ) || defined( FHEROES2_IMAGE_NEON )
+        if ( isVectorizationEnabled ) {
+            for ( ; x + blockSize <= width; x += blockSize ) {
+                // Blending is done through the palette so only fully transparent blocks can be processed at once.
+                if ( !isBlockFilledWith( transformIn + x, 1 ) ) {
+                    alphaBlitPixels( imageIn + x, transformIn + x, imageOut + x, blockSize, alphaValue, gamePalette );
+                }
+            }
+        }
+#endif
+
+        alphaBlitPixels( imageIn + x, transformIn + x, imageOut + x, width - x, alphaValue, gamePalette );
+    }
+
+    // Applies the table only to pixels with the given transform value.
+    void applyTableToPixels( const uint8_t * imageIn, const uint8_t * transformIn, uint8_t * imageOut, const int32_t count, const uint8_t * table )
+    {
+        const uint8_t * imageInEnd = imageIn + count;
+
+        for ( ; imageIn != imageInEnd; ++imageIn, ++imageOut, ++transformIn ) {
+            if ( *transformIn == 0 ) { // only modify pixels with data
+                *imageOut = table[*imageIn];
+            }
+        }
+    }
+
+    void applyTableToRow( const uint8_t * imageIn, const uint8_t * transformIn, uint8_t * imageOut, const int32_t width, const uint8_t * table )
+    {
+        int32_t x = 0;
+
+#if defined( FHEROES2_IMAGE_SSE2 ) || defined( FHEROES2_IMAGE_NEON )
+        if ( isVectorizationEnabled ) {
+            for ( ; x + blockSize <= width; x += blockSize ) {
+                // Table lookups can't be vectorized without gather operations so only blocks without any data are skipped at once
+                // and blocks which have data in every pixel are processed without branches.
+                const PixelBlock dataMask = equalMask( loadBlock( transformIn + x ), 0 );
+
+                if ( isMaskFull( dataMask ) ) {
+                    for ( int32_t i = x; i < x + blockSize; ++i ) {
+                        imageOut[i] = table[imageIn[i]];
+                    }
+                }
+                else if ( !isMaskEmpty( dataMask ) ) {
+                    applyTableToPixels( imageIn + x, transformIn + x, imageOut + x, blockSize, table );
+                }
+            }
+        }
+#endif
+
+        applyTableToPixels( imageIn + x, transformIn + x, imageOut + x, width - x, table );
+    }
+
     void ApplyRawPalette( const fheroes2::Image & in, int32_t inX, int32_t inY, fheroes2::Image & out, int32_t outX, int32_t outY, int32_t width, int32_t height,
                           const uint8_t * palette )
     {
@@ -381,16 +679,7 @@ namespace
         const uint8_t * imageInYEnd = imageInY + height * widthIn;
 
         for ( ; imageInY != imageInYEnd; imageInY += widthIn, transformInY += widthIn, imageOutY += widthOut ) {
-            const uint8_t * imageInX = imageInY;
-            const uint8_t * transformInX = transformInY;
-            uint8_t * imageOutX = imageOutY;
-            const uint8_t * imageInXEnd = imageInX + width;
-
-            for ( ; imageInX != imageInXEnd; ++imageInX, ++imageOutX, ++transformInX ) {
-                if ( *transformInX == 0 ) { // only modify pixels with data
-                    *imageOutX = palette[*imageInX];
-                }
-            }
+            applyTableToRow( imageInY, transformInY, imageOutY, width, palette );
         }
     }
 }
@@ -816,29 +1105,7 @@ namespace fheroes2
             const uint8_t * imageInYEnd = imageInY + height * widthIn;
 
             for ( ; imageInY != imageInYEnd; imageInY += widthIn, transformInY += widthIn, imageOutY += widthOut ) {
-                const uint8_t * imageInX = imageInY;
-                const uint8_t * transformInX = transformInY;
-                uint8_t * imageOutX = imageOutY;
-                const uint8_t * imageInXEnd = imageInX + width;
-
-                for ( ; imageInX != imageInXEnd; ++imageInX, ++transformInX, ++imageOutX ) {
-                    if ( *transformInX == 1 ) { // skip pixel
-                        continue;
-                    }
-
-                    uint8_t inValue = *imageInX;
-                    if ( *transformInX > 1 ) {
-                        inValue = *( transformTable + ( *transformInX ) * 256 + *imageOutX );
-                    }
-
-                    const uint8_t * inPAL = gamePalette + inValue * 3;
-                    const uint8_t * outPAL = gamePalette + ( *imageOutX ) * 3;
-
-                    const uint32_t red = static_cast<uint32_t>( *inPAL ) * alphaValue + static_cast<uint32_t>( *outPAL ) * behindValue;
-                    const uint32_t green = static_cast<uint32_t>( *( inPAL + 1 ) ) * alphaValue + static_cast<uint32_t>( *( outPAL + 1 ) ) * behindValue;
-                    const uint32_t blue = static_cast<uint32_t>( *( inPAL + 2 ) ) * alphaValue + static_cast<uint32_t>( *( outPAL + 2 ) ) * behindValue;
-                    *imageOutX = GetPALColorId( static_cast<uint8_t>( red / 255 ), static_cast<uint8_t>( green / 255 ), static_cast<uint8_t>( blue / 255 ) );
-                }
+                alphaBlitRow( imageInY, transformInY, imageOutY, width, alphaValue, gamePalette );
             }
         }
     }
@@ -938,15 +1205,7 @@ namespace fheroes2
             const uint8_t * transformY = image.transform() + y * imageWidth + x;
 
             for ( ; imageY != imageYEnd; imageY += imageWidth, transformY += imageWidth ) {
-                uint8_t * imageX = imageY;
-                const uint8_t * transformX = transformY;
-                const uint8_t * imageXEnd = imageX + width;
-
-                for ( ; imageX != imageXEnd; ++imageX, ++transformX ) {
-                    if ( *transformX == 0 ) {
-                        *imageX = *( transformTable + transformId * 256 + *imageX );
-                    }
-                }
+                applyTableToRow( imageY, transformY, imageY, width, transformTable + transformId * 256 );
             }
         }
     }
@@ -1042,46 +1301,14 @@ namespace fheroes2
             if ( out.singleLayer() ) {
                 assert( !in.singleLayer() );
                 for ( ; imageInY != imageInYEnd; imageInY += widthIn, transformInY += widthIn, imageOutY += widthOut ) {
-                    const uint8_t * imageInX = imageInY;
-                    const uint8_t * transformInX = transformInY;
-                    uint8_t * imageOutX = imageOutY;
-                    const uint8_t * imageInXEnd = imageInX + width;
-
-                    for ( ; imageInX != imageInXEnd; ++imageInX, ++transformInX, ++imageOutX ) {
-                        if ( *transformInX > 0 ) { // apply a transformation
-                            if ( *transformInX != 1 ) { // skip pixel
-                                *imageOutX = *( transformTable + ( *transformInX ) * 256 + *imageOutX );
-                            }
-                        }
-                        else { // copy a pixel
-                            *imageOutX = *imageInX;
-                        }
-                    }
+                    blitRowOnSingleLayer( imageInY, transformInY, imageOutY, width );
                 }
             }
             else {
                 uint8_t * transformOutY = out.transform() + offsetOutY;
 
                 for ( ; imageInY != imageInYEnd; imageInY += widthIn, transformInY += widthIn, imageOutY += widthOut, transformOutY += widthOut ) {
-                    const uint8_t * imageInX = imageInY;
-                    const uint8_t * transformInX = transformInY;
-                    uint8_t * imageOutX = imageOutY;
-                    uint8_t * transformOutX = transformOutY;
-                    const uint8_t * imageInXEnd = imageInX + width;
-
-                    for ( ; imageInX != imageInXEnd; ++imageInX, ++transformInX, ++imageOutX, ++transformOutX ) {
-                        if ( *transformInX == 1 ) { // skip pixel
-                            continue;
-                        }
-
-                        if ( *transformInX > 0 && *transformOutX == 0 ) { // apply a transformation
-                            *imageOutX = *( transformTable + ( *transformInX ) * 256 + *imageOutX );
-                        }
-                        else { // copy a pixel
-                            *transformOutX = *transformInX;
-                            *imageOutX = *imageInX;
-                        }
-                    }
+                    blitRowOnDoubleLayer( imageInY, transformInY, imageOutY, transformOutY, width );
                 }
             }
         }
@@ -1812,6 +2039,15 @@ namespace fheroes2
         return GetPALColorId( red / 4, green / 4, blue / 4 );
     }
 
+    bool isImageVectorizationSupported()
+    {
+#if defined( FHEROES2_IMAGE_SSE2 ) || defined( FHEROES2_IMAGE_NEON )
+        return true;
+#else
+        return false;
+#endif
+    }
+
     Sprite makeShadow( const Sprite & in, const Point & shadowOffset, const uint8_t transformId )
     {
         if ( in.empty() || shadowOffset.x > 0 || shadowOffset.y < 0 )
@@ -2054,6 +2290,11 @@ namespace fheroes2
         }
     }
 
+    void setImageVectorization( const bool enable )
+    {
+        isVectorizationEnabled = enable;
+    }
+
     void SetPixel( Image & image, int32_t x, int32_t y, uint8_t value )
     {
         if ( image.empty() || x >= image.width() || y >= image.height() || x < 0 || y < 0 ) {
@@ -250,6 +250,9 @@ namespace fheroes2
     // Returns a closest color ID from the original game's palette
     uint8_t GetColorId( uint8_t red, uint8_t green, uint8_t blue );
 
+    // Returns true if Blit, AlphaBlit, ApplyPalette and ApplyTransform functions have vectorized (SSE2 or NEON) versions for the current platform.
+    bool isImageVectorizationSupported();
+
     Sprite makeShadow( const Sprite & in, const Point & shadowOffset, const uint8_t transformId );
 
     // This function does NOT check transform layer. If you intent to replace few colors at the same image please use ApplyPalette to be more efficient.
@@ -264,6 +267,9 @@ namespace fheroes2
     void Resize( const Image & in, const int32_t inX, const int32_t inY, const int32_t widthRoiIn, const int32_t heightRoiIn, Image & out, const int32_t outX,
                  const int32_t outY, const int32_t widthRoiOut, const int32_t heightRoiOut, const bool isSubpixelAccuracy = false );
 
+    // Vectorized image functions are enabled by default. Disabling them is useful only to compare performance with the scalar versions.
+    void setImageVectorization( const bool enable );
+
     // Please use value from the main palette only
     void SetPixel( Image & image, int32_t x, int32_t y, uint8_t value );
 
@@ -0,0 +1,183 @@
+/***************************************************************************
+ *   Free Heroes of Might and Magic II: https://github.com/ihhub/fheroes2  *
+ *   Copyright (C) 2021                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "image.h"
+#include "image_benchmark.h"
+#include "logging.h"
+#include "rand.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::string timeToString( const Clock::duration duration )
+    {
+        std::ostringstream os;
+        os << std::fixed << std::setprecision( 3 ) << std::chrono::duration<double, std::milli>( duration ).count() << " ms";
+        return os.str();
+    }
+
+    // Generates an image similar to a game sprite: an opaque shape with shadow pixels surrounded by transparent pixels.
+    fheroes2::Image generateSprite( const int32_t width, const int32_t height )
+    {
+        fheroes2::Image image( width, height );
+
+        uint8_t * imageData = image.image();
+        uint8_t * transformData = image.transform();
+
+        for ( int32_t y = 0; y < height; ++y ) {
+            const int32_t shapeBegin = static_cast<int32_t>( Rand::Get( 0, static_cast<uint32_t>( width / 4 ) ) );
+            const int32_t shapeEnd = width - static_cast<int32_t>( Rand::Get( 0, static_cast<uint32_t>( width / 4 ) ) );
+
+            for ( int32_t x = 0; x < width; ++x, ++imageData, ++transformData ) {
+                *imageData = static_cast<uint8_t>( Rand::Get( 10, 213 ) );
+
+                if ( x < shapeBegin || x >= shapeEnd ) {
+                    *transformData = 1;
+                }
+                else if ( x < shapeBegin + 4 ) {
+                    *transformData = static_cast<uint8_t>( Rand::Get( 2, 5 ) );
+                }
+                else {
+                    *transformData = 0;
+                }
+            }
+        }
+
+        return image;
+    }
+
+    bool isSameImage( const fheroes2::Image & first, const fheroes2::Image & second )
+    {
+        const size_t size = static_cast<size_t>( first.width() ) * static_cast<size_t>( first.height() );
+
+        return first.width() == second.width() && first.height() == second.height() && std::equal( first.image(), first.image() + size, second.image() )
+               && std::equal( first.transform(), first.transform() + size, second.transform() );
+    }
+}
+
+namespace fheroes2
+{
+    bool runImageBenchmark( const uint32_t iterations, const uint32_t seed )
+    {
+        Rand::CurrentThreadRandomDevice().seed( seed );
+
+        const int32_t screenWidth = 640;
+        const int32_t screenHeight = 480;
+        const int32_t spriteSize = 96;
+
+        const Image sprite = generateSprite( spriteSize, spriteSize );
+
+        // Outputs have transparent areas like sprites which are composed from several images.
+        const Image background = generateSprite( screenWidth, screenHeight );
+
+        std::vector<uint8_t> palette( 256 );
+        for ( uint8_t & value : palette ) {
+            value = static_cast<uint8_t>( Rand::Get( 0, 255 ) );
+        }
+
+        // Sprites are drawn over the whole screen like it is done for the adventure map.
+        std::vector<Point> positions;
+        for ( int32_t y = 0; y + spriteSize <= screenHeight; y += spriteSize / 2 ) {
+            for ( int32_t x = 0; x + spriteSize <= screenWidth; x += spriteSize / 2 ) {
+                positions.emplace_back( x, y );
+            }
+        }
+
+        struct Kernel
+        {
+            const char * name;
+            std::function<void( Image & output )> run;
+        };
+
+        const std::vector<Kernel> kernels{
+            { "Blit",
+              [&sprite, &positions]( Image & output ) {
+                  for ( const Point & pos : positions ) {
+                      Blit( sprite, output, pos.x, pos.y );
+                  }
+              } },
+            { "AlphaBlit",
+              [&sprite, &positions]( Image & output ) {
+                  for ( const Point & pos : positions ) {
+                      AlphaBlit( sprite, output, pos.x, pos.y, 128 );
+                  }
+              } },
+            { "ApplyPalette",
+              [&sprite, &positions, &palette]( Image & output ) {
+                  for ( const Point & pos : positions ) {
+                      ApplyPalette( sprite, 0, 0, output, pos.x, pos.y, spriteSize, spriteSize, palette );
+                  }
+              } },
+            { "ApplyTransform", []( Image & output ) { ApplyTransform( output, 0, 0, screenWidth, screenHeight, 3 ); } },
+            { "Copy", [&background]( Image & output ) { Copy( background, output ); } },
+        };
+
+        if ( !isImageVectorizationSupported() ) {
+            COUT( "Vectorized image functions are not supported on this platform, only the scalar versions are measured." );
+        }
+
+        bool isOutputValid = true;
+
+        for ( const Kernel & kernel : kernels ) {
+            Clock::duration times[2] = { Clock::duration( 0 ), Clock::duration( 0 ) };
+            std::vector<Image> outputs;
+            outputs.reserve( 2 );
+
+            for ( int vectorized = 0; vectorized < 2; ++vectorized ) {
+                setImageVectorization( vectorized == 1 );
+
+                Image output( screenWidth, screenHeight );
+
+                for ( uint32_t i = 0; i < iterations; ++i ) {
+                    Copy( background, output );
+
+                    const Clock::time_point start = Clock::now();
+                    kernel.run( output );
+                    times[vectorized] += Clock::now() - start;
+                }
+
+                outputs.emplace_back( std::move( output ) );
+            }
+
+            const bool isSameOutput = isSameImage( outputs[0], outputs[1] );
+            isOutputValid = isOutputValid && isSameOutput;
+
+            const double scalarTime = std::chrono::duration<double>( times[0] ).count();
+            const double vectorTime = std::chrono::duration<double>( times[1] ).count();
+
+            COUT( std::left << std::setw( 18 ) << kernel.name << " scalar: " << timeToString( times[0] ) << ", vectorized: " << timeToString( times[1] )
+                            << ", speedup: " << std::fixed << std::setprecision( 2 ) << ( vectorTime > 0 ? scalarTime / vectorTime : 0.0 )
+                            << ( isSameOutput ? "" : ", OUTPUTS DIFFER" ) );
+        }
+
+        setImageVectorization( true );
+
+        return isOutputValid;
+    }
+}
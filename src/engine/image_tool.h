@@ -33,5 +33,9 @@ namespace fheroes2
 
     bool Load( const std::string & path, Image & image );
 
+    // Version of the output of decodeICNSprite(). It must be incremented with every change of the decoder which changes the decoded sprites
+    // as they are cached on disk between launches.
+    const uint32_t icnSpriteDecoderVersion = 1;
+
     Sprite decodeICNSprite( const uint8_t * data, uint32_t sizeData, const int32_t width, const int32_t height, const int16_t offsetX, const int16_t offsetY );
 }
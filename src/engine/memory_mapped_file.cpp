@@ -0,0 +1,160 @@
+/***************************************************************************
+ *   Free Heroes of Might and Magic II: https://github.com/ihhub/fheroes2  *
+ *   Copyright (C) 2021                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "memory_mapped_file.h"
+
+#if defined( __MINGW32__ ) || defined( _MSC_VER )
+#include <windows.h>
+#elif defined( FHEROES2_VITA ) || defined( __SWITCH__ )
+#include "serialize.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fheroes2
+{
+    MemoryMappedFile::~MemoryMappedFile()
+    {
+        close();
+    }
+
+#if defined( __MINGW32__ ) || defined( _MSC_VER )
+    bool MemoryMappedFile::open( const std::string & fileName )
+    {
+        close();
+
+        const HANDLE file = CreateFileA( fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+        if ( file == INVALID_HANDLE_VALUE ) {
+            return false;
+        }
+
+        LARGE_INTEGER fileSize;
+        if ( !GetFileSizeEx( file, &fileSize ) || fileSize.QuadPart <= 0 ) {
+            CloseHandle( file );
+            return false;
+        }
+
+        // The mapping keeps the file open so the file handle is not needed anymore.
+        const HANDLE mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+        CloseHandle( file );
+
+        if ( mapping == nullptr ) {
+            return false;
+        }
+
+        const void * data = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+        if ( data == nullptr ) {
+            CloseHandle( mapping );
+            return false;
+        }
+
+        _mapping = mapping;
+        _data = static_cast<const uint8_t *>( data );
+        _size = static_cast<size_t>( fileSize.QuadPart );
+
+        return true;
+    }
+
+    void MemoryMappedFile::close()
+    {
+        if ( _data != nullptr ) {
+            UnmapViewOfFile( _data );
+            CloseHandle( _mapping );
+        }
+
+        _mapping = nullptr;
+        _data = nullptr;
+        _size = 0;
+    }
+#elif defined( FHEROES2_VITA ) || defined( __SWITCH__ )
+    bool MemoryMappedFile::open( const std::string & fileName )
+    {
+        close();
+
+        StreamFile file;
+        if ( !file.open( fileName, "rb" ) ) {
+            return false;
+        }
+
+        _buffer = file.getRaw();
+        if ( _buffer.empty() ) {
+            return false;
+        }
+
+        _data = _buffer.data();
+        _size = _buffer.size();
+
+        return true;
+    }
+
+    void MemoryMappedFile::close()
+    {
+        _buffer.clear();
+        _buffer.shrink_to_fit();
+
+        _data = nullptr;
+        _size = 0;
+    }
+#else
+    bool MemoryMappedFile::open( const std::string & fileName )
+    {
+        close();
+
+        const int file = ::open( fileName.c_str(), O_RDONLY );
+        if ( file < 0 ) {
+            return false;
+        }
+
+        struct stat fileStat;
+        if ( fstat( file, &fileStat ) != 0 || fileStat.st_size <= 0 ) {
+            ::close( file );
+            return false;
+        }
+
+        const size_t size = static_cast<size_t>( fileStat.st_size );
+
+        // The mapping stays valid after the file is closed.
+        void * data = mmap( nullptr, size, PROT_READ, MAP_PRIVATE, file, 0 );
+        ::close( file );
+
+        if ( data == MAP_FAILED ) {
+            return false;
+        }
+
+        _data = static_cast<const uint8_t *>( data );
+        _size = size;
+
+        return true;
+    }
+
+    void MemoryMappedFile::close()
+    {
+        if ( _data != nullptr ) {
+            munmap( const_cast<uint8_t *>( _data ), _size );
+        }
+
+        _data = nullptr;
+        _size = 0;
+    }
+#endif
+}
@@ -0,0 +1,69 @@
+/***************************************************************************
+ *   Free Heroes of Might and Magic II: https://github.com/ihhub/fheroes2  *
+ *   Copyright (C) 2021                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fheroes2
+{
+    // Read-only content of a whole file mapped into memory. Pages are loaded by the system on access so opening even a big file is cheap.
+    // On platforms without memory mapping support the file is read into memory.
+    class MemoryMappedFile
+    {
+    public:
+        MemoryMappedFile() = default;
+        MemoryMappedFile( const MemoryMappedFile & ) = delete;
+
+        ~MemoryMappedFile();
+
+        MemoryMappedFile & operator=( const MemoryMappedFile & ) = delete;
+
+        bool open( const std::string & fileName );
+        void close();
+
+        bool isOpen() const
+        {
+            return _data != nullptr;
+        }
+
+        const uint8_t * data() const
+        {
+            return _data;
+        }
+
+        size_t size() const
+        {
+            return _size;
+        }
+
+    private:
+        const uint8_t * _data = nullptr;
+        size_t _size = 0;
+
+#if defined( __MINGW32__ ) || defined( _MSC_VER )
+        void * _mapping = nullptr;
+#elif defined( FHEROES2_VITA ) || defined( __SWITCH__ )
+        std::vector<uint8_t> _buffer;
+#endif
+    };
+}
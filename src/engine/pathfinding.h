@@ -20,8 +20,98 @@
 
 #pragma once
 
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
 #include "route.h"
 
+// Monotone priority queue for small non-negative integer costs (Dial's algorithm). The cost of every pushed element
+// must not be less than the cost of the last popped element. Elements with the same cost are popped in FIFO order.
+class BucketQueue
+{
+public:
+    void push( const int value, const uint32_t cost )
+    {
+        assert( cost >= _currentCost );
+
+        const size_t offset = cost - _currentCost;
+        if ( offset >= _buckets.size() ) {
+            resize( offset + 1 );
+        }
+
+        _buckets[( _currentBucket + offset ) & ( _buckets.size() - 1 )].push_back( value );
+        ++_size;
+    }
+
+    // Returns the element with the lowest cost
+    int pop( uint32_t & cost )
+    {
+        assert( _size > 0 );
+
+        while ( _readPosition >= _buckets[_currentBucket].size() ) {
+            _buckets[_currentBucket].clear();
+            _readPosition = 0;
+            _currentBucket = ( _currentBucket + 1 ) & ( _buckets.size() - 1 );
+            ++_currentCost;
+        }
+
+        --_size;
+        cost = _currentCost;
+        return _buckets[_currentBucket][_readPosition++];
+    }
+
+    bool empty() const
+    {
+        return _size == 0;
+    }
+
+    // Empties the queue. The cost of the first pushed elements must not be less than the given start cost. The buckets
+    // are sized by the spread of the queued costs so an oversized bucket array left from a previous run is released.
+    void clear( const uint32_t startCost = 0 )
+    {
+        if ( _buckets.size() > _maxKeptBucketCount ) {
+            std::vector<std::vector<int>>().swap( _buckets );
+        }
+        else {
+            for ( std::vector<int> & bucket : _buckets ) {
+                bucket.clear();
+            }
+        }
+
+        _currentBucket = 0;
+        _readPosition = 0;
+        _currentCost = startCost;
+        _size = 0;
+    }
+
+private:
+    static const size_t _maxKeptBucketCount = 1024;
+
+    // The number of buckets is always a power of 2 to wrap around them using a bit mask
+    void resize( const size_t minimumSize )
+    {
+        size_t newSize = _buckets.empty() ? 16 : _buckets.size();
+        while ( newSize < minimumSize ) {
+            newSize *= 2;
+        }
+
+        std::vector<std::vector<int>> buckets( newSize );
+        for ( size_t i = 0; i < _buckets.size(); ++i ) {
+            buckets[i].swap( _buckets[( _currentBucket + i ) & ( _buckets.size() - 1 )] );
+        }
+
+        _buckets.swap( buckets );
+        _currentBucket = 0;
+    }
+
+    std::vector<std::vector<int>> _buckets;
+    size_t _currentBucket = 0;
+    size_t _readPosition = 0;
+    uint32_t _currentCost = 0;
+    size_t _size = 0;
+};
+
 // Base representation of the dataset that mirrors the 2D map being traversed
 template <class T>
 struct PathfindingNode
@@ -63,7 +153,54 @@ public:
         return _cache[targetIndex];
     }
 
+    // Statistics of the last calculation: the number of queued nodes and the number of nodes actually explored
+    uint32_t getQueuedNodeCount() const
+    {
+        return _queuedNodeCount;
+    }
+
+    uint32_t getExploredNodeCount() const
+    {
+        return _exploredNodeCount;
+    }
+
 protected:
+    // The cost of every queued node must not be less than the start cost
+    void startExploration( const uint32_t startCost = 0 )
+    {
+        _nodesToExplore.clear( startCost );
+        _queuedNodeCount = 0;
+        _exploredNodeCount = 0;
+    }
+
+    // Queues the node for exploration using its current cost as a priority
+    void queueNode( const int index )
+    {
+        _nodesToExplore.push( index, _cache[index]._cost );
+        ++_queuedNodeCount;
+    }
+
+    // Returns the queued node with the lowest cost or -1 if there is nothing left to explore. Outdated entries (the node
+    // has been updated after being queued) are skipped so every node is explored only once per cost value.
+    int getNextNode()
+    {
+        while ( !_nodesToExplore.empty() ) {
+            uint32_t cost = 0;
+            const int index = _nodesToExplore.pop( cost );
+            if ( _cache[index]._cost == cost ) {
+                ++_exploredNodeCount;
+                return index;
+            }
+        }
+
+        return -1;
+    }
+
     std::vector<T> _cache;
     int _pathStart = -1;
+
+private:
+    BucketQueue _nodesToExplore;
+    uint32_t _queuedNodeCount = 0;
+    uint32_t _exploredNodeCount = 0;
 };
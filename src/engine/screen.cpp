@@ -20,6 +20,7 @@
 
 #include "screen.h"
 #include "image_palette.h"
+#include "thread_pool.h"
 #include "tools.h"
 
 #include <SDL_version.h>
@@ -35,6 +36,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cmath>
 #include <set>
 
@@ -181,6 +183,34 @@ namespace
         return true;
     }
 
+    // Merges areas which overlap or are close to each other so their bounding rectangle is not much bigger than the areas themselves.
+    // Every area is converted and uploaded to the screen separately so it is cheaper to render few big areas than many small ones.
+    std::vector<fheroes2::Rect> coalesceAreas( std::vector<fheroes2::Rect> areas )
+    {
+        const auto getArea = []( const fheroes2::Rect & roi ) { return static_cast<int64_t>( roi.width ) * roi.height; };
+
+        bool isMerged = true;
+        while ( isMerged ) {
+            isMerged = false;
+
+            for ( size_t first = 0; first < areas.size() && !isMerged; ++first ) {
+                for ( size_t second = first + 1; second < areas.size(); ++second ) {
+                    const fheroes2::Rect boundary = fheroes2::getBoundaryRect( areas[first], areas[second] );
+                    const int64_t separateArea = getArea( areas[first] ) + getArea( areas[second] );
+
+                    if ( ( areas[first] & areas[second] ) || getArea( boundary ) * 4 <= separateArea * 5 ) {
+                        areas[first] = boundary;
+                        areas.erase( areas.begin() + static_cast<std::ptrdiff_t>( second ) );
+                        isMerged = true;
+                        break;
+                    }
+                }
+            }
+        }
+
+        return areas;
+    }
+
     const uint8_t * currentPalette = PALPalette();
 
 // If SDL library is used
@@ -191,6 +221,39 @@ namespace
         std::vector<uint32_t> _palette32Bit;
         std::vector<SDL_Color> _palette8Bit;
 
+        // Converts palette indexes into 32-bit colors. Big areas are split into stripes of rows which are converted in parallel.
+        void convertTo32Bit( const uint8_t * in, const int32_t inPitch, uint32_t * out, const int32_t outPitch, const int32_t width, const int32_t height ) const
+        {
+            const uint32_t * transform = _palette32Bit.data();
+
+            const auto convertRows = [in, inPitch, out, outPitch, width, transform]( const int32_t rowBegin, const int32_t rowEnd ) {
+                for ( int32_t y = rowBegin; y < rowEnd; ++y ) {
+                    const uint8_t * inX = in + static_cast<ptrdiff_t>( y ) * inPitch;
+                    uint32_t * outX = out + static_cast<ptrdiff_t>( y ) * outPitch;
+                    const uint32_t * outXEnd = outX + width;
+
+                    for ( ; outX != outXEnd; ++outX, ++inX )
+                        *outX = *( transform + *inX );
+                }
+            };
+
+            // Waking up worker threads costs more than the conversion of small areas.
+            const int32_t minPixelsPerStripe = 128 * 1024;
+
+            fheroes2::ThreadPool & threadPool = fheroes2::getThreadPool();
+            const int32_t stripeCount = std::min( static_cast<int32_t>( threadPool.threadCount() ), width * height / minPixelsPerStripe );
+
+            if ( stripeCount < 2 ) {
+                convertRows( 0, height );
+                return;
+            }
+
+            threadPool.parallelFor( static_cast<size_t>( stripeCount ), [&convertRows, height, stripeCount]( const size_t stripe ) {
+                const int32_t id = static_cast<int32_t>( stripe );
+                convertRows( height * id / stripeCount, height * ( id + 1 ) / stripeCount );
+            } );
+        }
+
         void copyImageToSurface( const fheroes2::Image & image, SDL_Surface * surface, const fheroes2::Rect & roi )
         {
             assert( surface != nullptr && !image.empty() );
@@ -205,13 +268,7 @@ namespace
 
             if ( fullFrame ) {
                 if ( surface->format->BitsPerPixel == 32 ) {
-                    uint32_t * out = static_cast<uint32_t *>( surface->pixels );
-                    const uint32_t * outEnd = out + imageWidth * imageHeight;
-                    const uint8_t * in = image.image();
-                    const uint32_t * transform = _palette32Bit.data();
-
-                    for ( ; out != outEnd; ++out, ++in )
-                        *out = *( transform + *in );
+                    convertTo32Bit( image.image(), imageWidth, static_cast<uint32_t *>( surface->pixels ), imageWidth, imageWidth, imageHeight );
                 }
                 else if ( surface->format->BitsPerPixel == 8 ) {
                     if ( surface->pixels != image.image() ) {
@@ -230,19 +287,8 @@ namespace
             }
             else {
                 if ( surface->format->BitsPerPixel == 32 ) {
-                    uint32_t * outY = static_cast<uint32_t *>( surface->pixels );
-                    const uint32_t * outYEnd = outY + imageWidth * roi.height;
-                    const uint8_t * inY = image.image() + roi.x + roi.y * imageWidth;
-                    const uint32_t * transform = _palette32Bit.data();
-
-                    for ( ; outY != outYEnd; outY += imageWidth, inY += imageWidth ) {
-                        uint32_t * outX = outY;
-                        const uint32_t * outXEnd = outX + roi.width;
-                        const uint8_t * inX = inY;
-
-                        for ( ; outX != outXEnd; ++outX, ++inX )
-                            *outX = *( transform + *inX );
-                    }
+                    convertTo32Bit( image.image() + roi.x + roi.y * imageWidth, imageWidth, static_cast<uint32_t *>( surface->pixels ), imageWidth, roi.width,
+                                    roi.height );
                 }
                 else if ( surface->format->BitsPerPixel == 8 ) {
                     if ( surface->pixels != image.image() ) {
@@ -881,6 +927,31 @@ namespace
             }
         }
 
+        void renderAreas( const fheroes2::Display & display, const std::vector<fheroes2::Rect> & areas ) override
+        {
+            // Only 32-bit areas are converted into the beginning of the surface so they can be uploaded one by one.
+            if ( _surface == nullptr || _texture == nullptr || _surface->format->BitsPerPixel != 32 ) {
+                fheroes2::BaseRenderEngine::renderAreas( display, areas );
+                return;
+            }
+
+            for ( const fheroes2::Rect & roi : areas ) {
+                copyImageToSurface( display, _surface, roi );
+
+                SDL_Rect area;
+                area.x = roi.x;
+                area.y = roi.y;
+                area.w = roi.width;
+                area.h = roi.height;
+
+                SDL_UpdateTexture( _texture, &area, _surface->pixels, _surface->pitch );
+            }
+
+            if ( SDL_SetRenderTarget( _renderer, nullptr ) == 0 && SDL_RenderCopy( _renderer, _texture, nullptr, nullptr ) == 0 ) {
+                SDL_RenderPresent( _renderer );
+            }
+        }
+
         bool allocate( int32_t & width_, int32_t & height_, bool isFullScreen ) override
         {
             clear();
@@ -1262,6 +1333,18 @@ namespace
 
 namespace fheroes2
 {
+    void BaseRenderEngine::renderAreas( const Display & display, const std::vector<Rect> & areas )
+    {
+        assert( !areas.empty() );
+
+        Rect boundary = areas.front();
+        for ( size_t i = 1; i < areas.size(); ++i ) {
+            boundary = getBoundaryRect( boundary, areas[i] );
+        }
+
+        render( display, boundary );
+    }
+
     void BaseRenderEngine::linkRenderSurface( uint8_t * surface ) const
     {
         Display::instance().linkRenderSurface( surface );
@@ -1273,6 +1356,7 @@ namespace fheroes2
         , _preprocessing( nullptr )
         , _postprocessing( nullptr )
         , _renderSurface( nullptr )
+        , _lastRenderTime( 0 )
     {
         _disableTransformLayer();
     }
@@ -1288,6 +1372,7 @@ namespace fheroes2
         _engine->clear();
 
         _prevRoi = {};
+        _prevCursorRoi = {};
 
         // allocate engine resources
         if ( !_engine->allocate( width_, height_, isFullScreen ) ) {
@@ -1322,7 +1407,16 @@ namespace fheroes2
         if ( !getActiveArea( temp, width(), height() ) )
             return;
 
-        getActiveArea( _prevRoi, width(), height() );
+        // Previous areas must be updated as well to remove anything drawn only for the previous frame.
+        std::vector<Rect> areas{ temp };
+        if ( getActiveArea( _prevRoi, width(), height() ) ) {
+            areas.push_back( _prevRoi );
+        }
+        if ( getActiveArea( _prevCursorRoi, width(), height() ) ) {
+            areas.push_back( _prevCursorRoi );
+        }
+
+        Rect cursorROI;
 
         if ( _cursor->isVisible() && _cursor->isSoftwareEmulation() && !_cursor->_image.empty() ) {
             const Sprite & cursorImage = _cursor->_image;
@@ -1331,14 +1425,14 @@ namespace fheroes2
 
             if ( !backup.empty() ) {
                 // ROI must include cursor's area as well, otherwise cursor won't be rendered.
-                Rect cursorROI( cursorImage.x(), cursorImage.y(), cursorImage.width(), cursorImage.height() );
+                cursorROI = { cursorImage.x(), cursorImage.y(), cursorImage.width(), cursorImage.height() };
                 if ( getActiveArea( cursorROI, width(), height() ) ) {
-                    temp = getBoundaryRect( temp, cursorROI );
+                    areas.push_back( cursorROI );
                 }
             }
 
             // Previous position of cursor must be updated as well to avoid ghost effect.
-            _renderFrame( getBoundaryRect( temp, _prevRoi ) );
+            _renderFrame( coalesceAreas( std::move( areas ) ) );
 
             if ( _postprocessing != nullptr ) {
                 _postprocessing();
@@ -1347,18 +1441,24 @@ namespace fheroes2
             Copy( backup, 0, 0, *this, backup.x(), backup.y(), backup.width(), backup.height() );
         }
         else {
-            _renderFrame( getBoundaryRect( temp, _prevRoi ) );
+            _renderFrame( coalesceAreas( std::move( areas ) ) );
 
             if ( _postprocessing != nullptr ) {
                 _postprocessing();
             }
         }
 
+        // Areas are kept separately, their bounding rectangle could be much bigger than both of them.
         _prevRoi = temp;
+        _prevCursorRoi = cursorROI;
     }
 
-    void Display::_renderFrame( const Rect & roi ) const
+    void Display::_renderFrame( const std::vector<Rect> & areas )
     {
+        assert( !areas.empty() );
+
+        const std::chrono::steady_clock::time_point renderStart = std::chrono::steady_clock::now();
+
         bool updateImage = true;
         if ( _preprocessing != nullptr ) {
             std::vector<uint8_t> palette;
@@ -1369,14 +1469,22 @@ namespace fheroes2
                 if ( updateImage ) {
                     // Pre-processing step is applied to the whole image so we forcefully render the full frame.
                     _engine->render( *this, Rect( 0, 0, width(), height() ) );
-                    return;
+                    updateImage = false;
                 }
             }
         }
 
         if ( updateImage ) {
-            _engine->render( *this, roi );
+            if ( areas.size() == 1 ) {
+                _engine->render( *this, areas.front() );
+            }
+            else {
+                _engine->renderAreas( *this, areas );
+            }
         }
+
+        _lastRenderTime = static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - renderStart ).count() );
     }
 
     void Display::subscribe( PreRenderProcessing preprocessing, PostRenderProcessing postprocessing )
@@ -1406,6 +1514,7 @@ namespace fheroes2
         clear();
 
         _prevRoi = {};
+        _prevCursorRoi = {};
     }
 
     void Display::changePalette( const uint8_t * palette ) const
@@ -23,6 +23,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace fheroes2
 {
@@ -91,6 +92,9 @@ namespace fheroes2
             // Do nothing.
         }
 
+        // Renders several areas of the image as one frame. By default their bounding rectangle is rendered.
+        virtual void renderAreas( const Display & display, const std::vector<Rect> & areas ); // declaration of this method is in source file
+
         virtual bool allocate( int32_t &, int32_t &, bool )
         {
             return false;
@@ -149,6 +153,12 @@ namespace fheroes2
         // nullptr input parameters means to set to default value
         void changePalette( const uint8_t * palette = nullptr ) const;
 
+        // Time in microseconds spent to convert and send the last rendered frame to the screen.
+        uint32_t lastRenderTime() const
+        {
+            return _lastRenderTime;
+        }
+
         friend BaseRenderEngine & engine();
         friend Cursor & cursor();
 
@@ -163,11 +173,16 @@ namespace fheroes2
         // Previous area drawn on the screen.
         Rect _prevRoi;
 
+        // Previous area of the software cursor.
+        Rect _prevCursorRoi;
+
+        uint32_t _lastRenderTime;
+
         void linkRenderSurface( uint8_t * surface ); // only for cases of direct drawing on rendered 8-bit image
 
         Display();
 
-        void _renderFrame( const Rect & roi ) const; // prepare and render a frame
+        void _renderFrame( const std::vector<Rect> & areas ); // prepare and render a frame
     };
 
     class Cursor
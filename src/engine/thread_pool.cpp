@@ -0,0 +1,120 @@
+/***************************************************************************
+ *   Free Heroes of Might and Magic II: https://github.com/ihhub/fheroes2  *
+ *   Copyright (C) 2021                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <cassert>
+
+#include "thread_pool.h"
+
+namespace fheroes2
+{
+    ThreadPool::ThreadPool( const size_t threadCount )
+    {
+        size_t workerCount = ( threadCount > 0 ) ? threadCount : std::thread::hardware_concurrency();
+        if ( workerCount > 0 ) {
+            // The calling thread does the work as well.
+            --workerCount;
+        }
+
+        _workers.reserve( workerCount );
+        for ( size_t i = 0; i < workerCount; ++i ) {
+            _workers.emplace_back( ThreadPool::_workerThread, this );
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> guard( _mutex );
+            _exitFlag = true;
+            _workerNotification.notify_all();
+        }
+
+        for ( std::thread & worker : _workers ) {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::parallelFor( const size_t count, const std::function<void( size_t )> & function )
+    {
+        if ( _workers.empty() || count < 2 ) {
+            for ( size_t i = 0; i < count; ++i ) {
+                function( i );
+            }
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock( _mutex );
+        assert( _function == nullptr );
+
+        _function = &function;
+        _taskCount = count;
+        _nextTask = 0;
+        _workerNotification.notify_all();
+
+        _runTasks( lock );
+
+        _masterNotification.wait( lock, [this] { return _nextTask >= _taskCount && _runningTasks == 0; } );
+
+        _function = nullptr;
+        _taskCount = 0;
+        _nextTask = 0;
+    }
+
+    void ThreadPool::_runTasks( std::unique_lock<std::mutex> & lock )
+    {
+        while ( _nextTask < _taskCount ) {
+            const size_t taskId = _nextTask++;
+            ++_runningTasks;
+
+            lock.unlock();
+            ( *_function )( taskId );
+            lock.lock();
+
+            --_runningTasks;
+        }
+
+        if ( _runningTasks == 0 ) {
+            _masterNotification.notify_all();
+        }
+    }
+
+    void ThreadPool::_workerThread( ThreadPool * pool )
+    {
+        assert( pool != nullptr );
+
+        std::unique_lock<std::mutex> lock( pool->_mutex );
+
+        while ( true ) {
+            pool->_workerNotification.wait( lock, [pool] { return pool->_exitFlag || pool->_nextTask < pool->_taskCount; } );
+
+            if ( pool->_exitFlag ) {
+                return;
+            }
+
+            pool->_runTasks( lock );
+        }
+    }
+
+    ThreadPool & getThreadPool()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+}
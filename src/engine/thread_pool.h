@@ -0,0 +1,73 @@
+/***************************************************************************
+ *   Free Heroes of Might and Magic II: https://github.com/ihhub/fheroes2  *
+ *   Copyright (C) 2021                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fheroes2
+{
+    // Set of worker threads to run independent computations in parallel.
+    class ThreadPool
+    {
+    public:
+        // The number of threads (including the calling one) matches the number of CPU cores if not specified.
+        explicit ThreadPool( const size_t threadCount = 0 );
+        ThreadPool( const ThreadPool & ) = delete;
+
+        ~ThreadPool();
+
+        ThreadPool & operator=( const ThreadPool & ) = delete;
+
+        // Calls the function for every index from 0 to count - 1 and waits until all calls are finished. The calling thread
+        // takes part in the work. Calls can be made in any order and at the same time so the function must not depend on it.
+        // This method must not be called from several threads at once or from the function itself.
+        void parallelFor( const size_t count, const std::function<void( size_t )> & function );
+
+        size_t threadCount() const
+        {
+            return _workers.size() + 1;
+        }
+
+    private:
+        std::vector<std::thread> _workers;
+        std::mutex _mutex;
+
+        std::condition_variable _workerNotification;
+        std::condition_variable _masterNotification;
+
+        const std::function<void( size_t )> * _function = nullptr;
+        size_t _taskCount = 0;
+        size_t _nextTask = 0;
+        size_t _runningTasks = 0;
+        bool _exitFlag = false;
+
+        void _runTasks( std::unique_lock<std::mutex> & lock );
+
+        static void _workerThread( ThreadPool * pool );
+    };
+
+    // Thread pool shared by the game logic.
+    ThreadPool & getThreadPool();
+}
@@ -20,7 +20,12 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
+#include <algorithm>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <zlib.h>
 
 #include "logging.h"
@@ -58,14 +63,14 @@ namespace
         return res;
     }
 
-    std::vector<u8> zlibCompress( const u8 * src, size_t srcsz )
+    std::vector<u8> zlibCompress( const u8 * src, size_t srcsz, const int level = Z_DEFAULT_COMPRESSION )
     {
         std::vector<u8> res;
 
         if ( src && srcsz ) {
             res.resize( compressBound( static_cast<uLong>( srcsz ) ) );
             uLong dstsz = static_cast<uLong>( res.size() );
-            int ret = compress( reinterpret_cast<Bytef *>( &res[0] ), &dstsz, reinterpret_cast<const Bytef *>( src ), static_cast<uLong>( srcsz ) );
+            int ret = compress2( reinterpret_cast<Bytef *>( &res[0] ), &dstsz, reinterpret_cast<const Bytef *>( src ), static_cast<uLong>( srcsz ), level );
 
             if ( ret == Z_OK )
                 res.resize( dstsz );
@@ -79,8 +84,161 @@ namespace
 
         return res;
     }
+
+    // Uncompressed size of chunks written by ZStreamChunkWriter.
+    const size_t chunkSize = 256 * 1024;
+
+    // ZStreamFile writes a non-zero uncompressed size at the beginning so a zero value tells that data is compressed by chunks.
+    const uint32_t chunkFormatMarker = 0;
+    const uint32_t chunkFormatVersion = 1;
+
+    // Limits memory used by chunks waiting for compression when serialization is faster than compression.
+    const size_t maxQueuedChunks = 4;
 }
 
+class ZStreamChunkWriter::Compressor
+{
+public:
+    Compressor( const int compressionLevel, const bool useBackgroundThread )
+        : _compressionLevel( compressionLevel )
+        , _useBackgroundThread( useBackgroundThread )
+    {}
+
+    Compressor( const Compressor & ) = delete;
+
+    ~Compressor()
+    {
+        stopWorker();
+    }
+
+    Compressor & operator=( const Compressor & ) = delete;
+
+    bool open( const std::string & fileName, const bool append )
+    {
+        _file.setbigendian( true );
+
+        if ( !_file.open( fileName, append ? "ab" : "wb" ) ) {
+            return false;
+        }
+
+        _file.put32( chunkFormatMarker );
+        _file.put32( chunkFormatVersion );
+
+        _isOpen = true;
+        _isGood = !_file.fail();
+
+        if ( _useBackgroundThread ) {
+            _exitFlag = false;
+            _worker = std::thread( workerThread, this );
+        }
+
+        return _isGood;
+    }
+
+    void push( std::vector<uint8_t> && chunk )
+    {
+        if ( !_worker.joinable() ) {
+            write( chunk );
+            return;
+        }
+
+        std::unique_lock<std::mutex> mutexLock( _mutex );
+        _masterNotification.wait( mutexLock, [this] { return _queue.size() < maxQueuedChunks; } );
+
+        _queue.emplace_back( std::move( chunk ) );
+        _workerNotification.notify_one();
+    }
+
+    bool finish()
+    {
+        stopWorker();
+
+        if ( !_isOpen ) {
+            return false;
+        }
+
+        // The end of data is marked by an empty chunk.
+        _file.put32( 0 );
+        _file.put32( 0 );
+
+        const bool result = _isGood && !_file.fail();
+
+        _file.close();
+        _isOpen = false;
+
+        return result;
+    }
+
+private:
+    StreamFile _file;
+
+    const int _compressionLevel;
+    const bool _useBackgroundThread;
+    bool _isOpen = false;
+    bool _isGood = false;
+
+    std::thread _worker;
+    std::mutex _mutex;
+    std::condition_variable _workerNotification;
+    std::condition_variable _masterNotification;
+    std::deque<std::vector<uint8_t>> _queue;
+    bool _exitFlag = false;
+
+    void write( const std::vector<uint8_t> & chunk )
+    {
+        const std::vector<uint8_t> zip = zlibCompress( chunk.data(), chunk.size(), _compressionLevel );
+        if ( zip.empty() ) {
+            _isGood = false;
+            return;
+        }
+
+        _file.put32( static_cast<uint32_t>( chunk.size() ) );
+        _file.put32( static_cast<uint32_t>( zip.size() ) );
+        _file.putRaw( reinterpret_cast<const char *>( zip.data() ), zip.size() );
+
+        if ( _file.fail() ) {
+            _isGood = false;
+        }
+    }
+
+    void stopWorker()
+    {
+        if ( !_worker.joinable() ) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> mutexLock( _mutex );
+            _exitFlag = true;
+        }
+
+        _workerNotification.notify_one();
+        _worker.join();
+    }
+
+    // Queued chunks are always written before the thread exits.
+    static void workerThread( Compressor * compressor )
+    {
+        std::unique_lock<std::mutex> mutexLock( compressor->_mutex );
+
+        while ( true ) {
+            compressor->_workerNotification.wait( mutexLock, [compressor] { return compressor->_exitFlag || !compressor->_queue.empty(); } );
+
+            if ( compressor->_queue.empty() ) {
+                break;
+            }
+
+            const std::vector<uint8_t> chunk = std::move( compressor->_queue.front() );
+            compressor->_queue.pop_front();
+            compressor->_masterNotification.notify_one();
+
+            mutexLock.unlock();
+            compressor->write( chunk );
+            mutexLock.lock();
+        }
+    }
+};
+
 bool ZStreamFile::read( const std::string & fn, size_t offset )
 {
     StreamFile sf;
@@ -126,6 +284,175 @@ bool ZStreamFile::write( const std::string & fn, bool append ) const
     return false;
 }
 
+ZStreamChunkWriter::ZStreamChunkWriter( const int compressionLevel, const bool useBackgroundThread )
+    : StreamBuf( chunkSize )
+    , _compressor( new Compressor( compressionLevel, useBackgroundThread ) )
+{}
+
+ZStreamChunkWriter::~ZStreamChunkWriter() = default;
+
+bool ZStreamChunkWriter::open( const std::string & fileName, const bool append )
+{
+    reset();
+
+    return _compressor->open( fileName, append );
+}
+
+bool ZStreamChunkWriter::close()
+{
+    flushChunk();
+
+    return _compressor->finish();
+}
+
+void ZStreamChunkWriter::putRaw( const char * ptr, size_t size )
+{
+    while ( size > 0 ) {
+        if ( sizep() == 0 ) {
+            flushChunk();
+        }
+
+        const size_t copySize = std::min( size, sizep() );
+        std::copy( ptr, ptr + copySize, itput );
+        itput += copySize;
+
+        ptr += copySize;
+        size -= copySize;
+    }
+}
+
+void ZStreamChunkWriter::put8( const uint8_t v )
+{
+    if ( sizep() == 0 ) {
+        flushChunk();
+    }
+
+    StreamBuf::put8( v );
+}
+
+void ZStreamChunkWriter::flushChunk()
+{
+    if ( sizeg() == 0 ) {
+        return;
+    }
+
+    _compressor->push( std::vector<uint8_t>( itget, itput ) );
+    reset();
+}
+
+bool ZStreamChunkReader::open( const std::string & fileName, const size_t offset )
+{
+    _file.setbigendian( true );
+
+    if ( !_file.open( fileName, "rb" ) ) {
+        return false;
+    }
+
+    if ( offset ) {
+        _file.seek( offset );
+    }
+
+    const uint32_t rawSize = _file.get32();
+    if ( rawSize != chunkFormatMarker ) {
+        // Data written by ZStreamFile.
+        const uint32_t zipSize = _file.get32();
+        if ( zipSize == 0 ) {
+            return false;
+        }
+
+        _file.skip( 4 ); // old stream format
+        const std::vector<u8> zip = _file.getRaw( zipSize );
+        _file.close();
+
+        assign( zlibDecompress( zip.data(), zip.size(), rawSize ) );
+        return sizeg() > 0;
+    }
+
+    if ( _file.get32() != chunkFormatVersion ) {
+        return false;
+    }
+
+    return readNextChunk();
+}
+
+void ZStreamChunkReader::skip( size_t size )
+{
+    while ( size > 0 && ( sizeg() > 0 || readNextChunk() ) ) {
+        const size_t skipSize = std::min( size, sizeg() );
+        itget += skipSize;
+        size -= skipSize;
+    }
+}
+
+std::vector<u8> ZStreamChunkReader::getRaw( size_t size )
+{
+    std::vector<u8> result;
+    result.reserve( size );
+
+    while ( ( size == 0 || result.size() < size ) && ( sizeg() > 0 || readNextChunk() ) ) {
+        const size_t copySize = size == 0 ? sizeg() : std::min( size - result.size(), sizeg() );
+        result.insert( result.end(), itget, itget + copySize );
+        itget += copySize;
+    }
+
+    // Same as StreamBuf, missing data is filled by zeros.
+    result.resize( std::max( size, result.size() ), 0 );
+
+    return result;
+}
+
+u8 ZStreamChunkReader::get8()
+{
+    if ( sizeg() == 0 && !readNextChunk() ) {
+        return 0;
+    }
+
+    return StreamBuf::get8();
+}
+
+bool ZStreamChunkReader::readNextChunk()
+{
+    const uint32_t rawSize = _file.get32();
+    const uint32_t zipSize = _file.get32();
+
+    if ( rawSize == 0 || zipSize == 0 ) {
+        // The end of data or the file is closed already.
+        _file.close();
+        return false;
+    }
+
+    const std::vector<u8> zip = _file.getRaw( zipSize );
+
+    reset();
+    reallocbuf( rawSize );
+
+    uLong dstSize = static_cast<uLong>( rawSize );
+    const int ret = uncompress( reinterpret_cast<Bytef *>( itbeg ), &dstSize, reinterpret_cast<const Bytef *>( zip.data() ), static_cast<uLong>( zip.size() ) );
+    if ( _file.fail() || ret != Z_OK || dstSize != rawSize ) {
+        ERROR_LOG( "zlib error: " << ret );
+        _file.close();
+        setfail( true );
+        return false;
+    }
+
+    itput = itbeg + rawSize;
+
+    return true;
+}
+
+void ZStreamChunkReader::assign( const std::vector<u8> & data )
+{
+    reset();
+
+    if ( data.empty() ) {
+        return;
+    }
+
+    reallocbuf( data.size() );
+    std::copy( data.begin(), data.end(), itbeg );
+    itput = itbeg + data.size();
+}
+
 fheroes2::Image CreateImageFromZlib( int32_t width, int32_t height, const uint8_t * imageData, size_t imageSize, bool doubleLayer )
 {
     if ( imageData == nullptr || imageSize == 0 || width <= 0 || height <= 0 )
@@ -23,6 +23,7 @@
 #ifndef H2ZLIB_H
 #define H2ZLIB_H
 
+#include <memory>
 #include <vector>
 
 #include "image.h"
@@ -38,6 +39,58 @@ public:
     bool write( const std::string &, bool append = false ) const;
 };
 
+// Compresses data by chunks of a fixed size while it is being put so the whole uncompressed data is never kept in memory.
+// Chunks are compressed independently, optionally by a background thread while the caller keeps putting data.
+class ZStreamChunkWriter : public StreamBuf
+{
+public:
+    ZStreamChunkWriter( const int compressionLevel, const bool useBackgroundThread );
+    ZStreamChunkWriter( const ZStreamChunkWriter & ) = delete;
+
+    ~ZStreamChunkWriter() override;
+
+    ZStreamChunkWriter & operator=( const ZStreamChunkWriter & ) = delete;
+
+    bool open( const std::string & fileName, const bool append );
+
+    // Writes the remaining data and closes the file. Returns false if any data was not written.
+    bool close();
+
+    void putRaw( const char * ptr, size_t size ) override;
+
+protected:
+    void put8( const uint8_t v ) override;
+
+private:
+    class Compressor;
+
+    std::unique_ptr<Compressor> _compressor;
+
+    void flushChunk();
+};
+
+// Reads data written by ZStreamChunkWriter decompressing one chunk at a time.
+// Data written by ZStreamFile is supported as well but it is decompressed completely at once.
+class ZStreamChunkReader : public StreamBuf
+{
+public:
+    ZStreamChunkReader() = default;
+
+    bool open( const std::string & fileName, const size_t offset );
+
+    void skip( size_t size ) override;
+    std::vector<u8> getRaw( size_t size = 0 /* all data */ ) override;
+
+protected:
+    u8 get8() override;
+
+private:
+    StreamFile _file;
+
+    bool readNextChunk();
+    void assign( const std::vector<u8> & data );
+};
+
 fheroes2::Image CreateImageFromZlib( int32_t width, int32_t height, const uint8_t * imageData, size_t imageSize, bool doubleLayer );
 
 #endif
@@ -34,6 +34,7 @@
 #include "dir.h"
 #include "embedded_image.h"
 #include "game.h"
+#include "icn_cache.h"
 #include "localevent.h"
 #include "logging.h"
 #include "m82.h"
@@ -63,6 +64,7 @@ namespace AGG
         int channel;
     };
 
+    // AGG files are read-only so they are shared by the main thread, the music thread and the asset prefetching thread.
     fheroes2::AGGFile heroes2_agg;
     fheroes2::AGGFile heroes2x_agg;
 
@@ -77,15 +79,12 @@ namespace AGG
     void LoadMID( int xmi, std::vector<u8> & );
 
     bool ReadDataDir( void );
-    std::vector<uint8_t> ReadMusicChunk( const std::string & key, const bool ignoreExpansion = false );
+    fheroes2::AGGFile::FileView getMusicChunkView( const std::string & key, const bool ignoreExpansion = false );
 
     void PlayMusicInternally( const int mus, const MusicSource musicType, const bool loop );
     void PlaySoundInternally( const int m82, const int soundVolume );
     void LoadLOOPXXSoundsInternally( const std::vector<int> & vols, const int soundVolume );
 
-    fheroes2::AGGFile g_midiHeroes2AGG;
-    fheroes2::AGGFile g_midiHeroes2xAGG;
-
     // SDL MIDI player is single threaded library which requires a lot of time for some long midi compositions.
     // This leads to a situation of short application freeze while a hero crosses terrains or ending a battle.
     // The only way to avoid this is to fire MIDI requests asynchronously and synchronize them if needed.
@@ -330,11 +329,9 @@ bool AGG::ReadDataDir( void )
         std::string lower = StringLower( *it );
         if ( std::string::npos != lower.find( "heroes2.agg" ) && !heroes2_agg.isGood() ) {
             heroes2_agg.open( *it );
-            g_midiHeroes2AGG.open( *it );
         }
         if ( std::string::npos != lower.find( "heroes2x.agg" ) && !heroes2x_agg.isGood() ) {
             heroes2x_agg.open( *it );
-            g_midiHeroes2xAGG.open( *it );
         }
     }
 
@@ -344,38 +341,42 @@ bool AGG::ReadDataDir( void )
 }
 
 std::vector<uint8_t> AGG::ReadChunk( const std::string & key )
+{
+    const fheroes2::AGGFile::FileView chunk = getChunkView( key );
+    return std::vector<uint8_t>( chunk.data, chunk.data + chunk.size );
+}
+
+fheroes2::AGGFile::FileView AGG::getChunkView( const std::string & key )
 {
     if ( heroes2x_agg.isGood() ) {
-        const std::vector<uint8_t> & buf = heroes2x_agg.read( key );
-        if ( !buf.empty() )
-            return buf;
+        const fheroes2::AGGFile::FileView chunk = heroes2x_agg.view( key );
+        if ( !chunk.empty() )
+            return chunk;
     }
 
-    return heroes2_agg.read( key );
+    return heroes2_agg.view( key );
 }
 
-std::vector<uint8_t> AGG::ReadMusicChunk( const std::string & key, const bool ignoreExpansion )
+fheroes2::AGGFile::FileView AGG::getMusicChunkView( const std::string & key, const bool ignoreExpansion )
 {
-    if ( !ignoreExpansion && g_midiHeroes2xAGG.isGood() ) {
-        const std::vector<uint8_t> & buf = g_midiHeroes2xAGG.read( key );
-        if ( !buf.empty() )
-            return buf;
+    if ( !ignoreExpansion ) {
+        return getChunkView( key );
     }
 
-    return g_midiHeroes2AGG.read( key );
+    return heroes2_agg.view( key );
 }
 
 /* load 82M object to AGG::Cache in Audio::CVT */
 void AGG::LoadWAV( int m82, std::vector<u8> & v )
 {
     DEBUG_LOG( DBG_ENGINE, DBG_TRACE, M82::GetString( m82 ) );
-    const std::vector<u8> & body = ReadMusicChunk( M82::GetString( m82 ) );
+    const fheroes2::AGGFile::FileView body = getMusicChunkView( M82::GetString( m82 ) );
 
     if ( !body.empty() ) {
         // create WAV format
         StreamBuf wavHeader( 44 );
         wavHeader.putLE32( 0x46464952 ); // RIFF
-        wavHeader.putLE32( static_cast<uint32_t>( body.size() ) + 0x24 ); // size
+        wavHeader.putLE32( static_cast<uint32_t>( body.size ) + 0x24 ); // size
         wavHeader.putLE32( 0x45564157 ); // WAVE
         wavHeader.putLE32( 0x20746D66 ); // FMT
         wavHeader.putLE32( 0x10 ); // size_t
@@ -386,11 +387,11 @@ void AGG::LoadWAV( int m82, std::vector<u8> & v )
         wavHeader.putLE16( 0x01 ); // align
         wavHeader.putLE16( 0x08 ); // bitsper
         wavHeader.putLE32( 0x61746164 ); // DATA
-        wavHeader.putLE32( static_cast<uint32_t>( body.size() ) ); // size
+        wavHeader.putLE32( static_cast<uint32_t>( body.size ) ); // size
 
-        v.reserve( body.size() + 44 );
+        v.reserve( body.size + 44 );
         v.assign( wavHeader.data(), wavHeader.data() + 44 );
-        v.insert( v.begin() + 44, body.begin(), body.end() );
+        v.insert( v.end(), body.data, body.data + body.size );
     }
 }
 
@@ -398,10 +399,10 @@ void AGG::LoadWAV( int m82, std::vector<u8> & v )
 void AGG::LoadMID( int xmi, std::vector<u8> & v )
 {
     DEBUG_LOG( DBG_ENGINE, DBG_TRACE, XMI::GetString( xmi ) );
-    const std::vector<uint8_t> & body = ReadMusicChunk( XMI::GetString( xmi ), xmi >= XMI::MIDI_ORIGINAL_KNIGHT );
+    const fheroes2::AGGFile::FileView body = getMusicChunkView( XMI::GetString( xmi ), xmi >= XMI::MIDI_ORIGINAL_KNIGHT );
 
     if ( !body.empty() ) {
-        v = Music::Xmi2Mid( body );
+        v = Music::Xmi2Mid( std::vector<uint8_t>( body.data, body.data + body.size ) );
     }
 }
 
@@ -601,7 +602,7 @@ void AGG::PlayMusicInternally( const int mus, const MusicSource musicType, const
         // Check if music needs to be pulled from HEROES2X
         int xmi = XMI::UNKNOWN;
         if ( musicType == MUSIC_MIDI_EXPANSION ) {
-            xmi = XMI::FromMUS( mus, g_midiHeroes2xAGG.isGood() );
+            xmi = XMI::FromMUS( mus, heroes2x_agg.isGood() );
         }
 
         if ( XMI::UNKNOWN == xmi ) {
@@ -647,6 +648,8 @@ void AGG::ResetMixer( bool asyncronizedCall /* = false */ )
 AGG::AGGInitializer::AGGInitializer()
 {
     if ( ReadDataDir() ) {
+        const uint64_t dataChecksum = ( static_cast<uint64_t>( heroes2_agg.checksum() ) << 32 ) | ( heroes2x_agg.isGood() ? heroes2x_agg.checksum() : 0 );
+        fheroes2::AGG::openICNCache( System::ConcatePath( System::ConcatePath( System::GetDataDirectory( "fheroes2" ), "files" ), "icn.cache" ), dataChecksum );
         return;
     }
 
@@ -667,6 +670,8 @@ AGG::AGGInitializer::AGGInitializer()
 
 AGG::AGGInitializer::~AGGInitializer()
 {
+    fheroes2::AGG::closeICNCache();
+
     wav_cache.clear();
     mid_cache.clear();
     loop_sounds.clear();
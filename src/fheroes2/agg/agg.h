@@ -27,6 +27,8 @@
 #include <string>
 #include <vector>
 
+#include "agg_file.h"
+
 namespace AGG
 {
     class AGGInitializer
@@ -47,6 +49,9 @@ namespace AGG
     void ResetMixer( bool asyncronizedCall = false );
 
     std::vector<uint8_t> ReadChunk( const std::string & key );
+
+    // Same as ReadChunk but without copying. It can be called from any thread.
+    fheroes2::AGGFile::FileView getChunkView( const std::string & key );
 }
 
 #endif
@@ -19,9 +19,11 @@
  ***************************************************************************/
 
 #include <array>
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <map>
+#include <utility>
 #include <vector>
 
 #include "agg.h"
@@ -29,8 +31,10 @@
 #include "agg_image.h"
 #include "h2d.h"
 #include "icn.h"
+#include "icn_cache.h"
 #include "image.h"
 #include "image_tool.h"
+#include "logging.h"
 #include "pal.h"
 #include "screen.h"
 #include "text.h"
@@ -60,6 +64,136 @@ namespace
         return id >= 0 && static_cast<size_t>( id ) < _tilVsImage.size();
     }
 
+    size_t getMemorySize( const fheroes2::Image & image )
+    {
+        const size_t pixelCount = static_cast<size_t>( image.width() ) * static_cast<size_t>( image.height() );
+        return image.singleLayer() ? pixelCount : pixelCount * 2;
+    }
+
+    template <typename T>
+    size_t getMemorySize( const std::vector<T> & images )
+    {
+        size_t size = 0;
+        for ( const T & image : images ) {
+            size += getMemorySize( image );
+        }
+        return size;
+    }
+
+    // This class tracks memory used by decoded ICNs and TILs and releases the least recently used of them when the memory budget is exceeded.
+    // ICN entries have the same IDs as ICNs while TIL entries are placed after them.
+    class ImageCache
+    {
+    public:
+        ImageCache()
+            : _lastAccess( ICN::LASTICN + TIL::LASTTIL, 0 )
+            , _size( ICN::LASTICN + TIL::LASTTIL, 0 )
+            , _isPinned( ICN::LASTICN + TIL::LASTTIL, false )
+        {
+            // Fonts might be modified for the current language so they cannot be reloaded from AGG files.
+            // Cursors and adventure map borders are on the screen almost all the time.
+            for ( const int icnId : { ICN::FONT, ICN::SMALFONT, ICN::YELLOW_FONT, ICN::YELLOW_SMALLFONT, ICN::GRAY_FONT, ICN::GRAY_SMALL_FONT, ICN::WHITE_LARGE_FONT,
+                                      ICN::ADVMCO, ICN::CMSECO, ICN::SPELCO, ICN::ADVBORD, ICN::ADVBORDE, ICN::ADVBTNS, ICN::ADVEBTNS } ) {
+                _isPinned[icnId] = true;
+            }
+        }
+
+        static size_t getTILEntryId( const int tilId )
+        {
+            return ICN::LASTICN + static_cast<size_t>( tilId );
+        }
+
+        void setBudget( const size_t bytes )
+        {
+            _budget = bytes;
+        }
+
+        void pin( const size_t entryId )
+        {
+            _isPinned[entryId] = true;
+        }
+
+        void onHit( const size_t entryId )
+        {
+            _lastAccess[entryId] = ++_accessCounter;
+            ++_statistics.hits;
+        }
+
+        void onLoad( const size_t entryId, const size_t bytes )
+        {
+            _lastAccess[entryId] = ++_accessCounter;
+            ++_statistics.misses;
+            updateSize( entryId, bytes );
+        }
+
+        void updateSize( const size_t entryId, const size_t bytes )
+        {
+            _statistics.bytesResident = _statistics.bytesResident - _size[entryId] + bytes;
+            _size[entryId] = bytes;
+        }
+
+        void releaseUnused()
+        {
+            if ( _budget > 0 && _statistics.bytesResident > _budget ) {
+                // Entries accessed after the previous call are considered as being in use. Releasing them would make us to decode them again for every frame.
+                std::vector<std::pair<uint64_t, size_t>> candidates;
+                for ( size_t entryId = 0; entryId < _size.size(); ++entryId ) {
+                    if ( _size[entryId] > 0 && !_isPinned[entryId] && _lastAccess[entryId] <= _lastReleaseAccess ) {
+                        candidates.emplace_back( _lastAccess[entryId], entryId );
+                    }
+                }
+
+                std::sort( candidates.begin(), candidates.end() );
+
+                for ( const std::pair<uint64_t, size_t> & candidate : candidates ) {
+                    if ( _statistics.bytesResident <= _budget ) {
+                        break;
+                    }
+
+                    release( candidate.second );
+                }
+
+                if ( _statistics.bytesResident > _budget ) {
+                    DEBUG_LOG( DBG_ENGINE, DBG_TRACE, "images in use take " << _statistics.bytesResident << " bytes which is more than the budget of " << _budget << " bytes" );
+                }
+            }
+
+            _lastReleaseAccess = _accessCounter;
+        }
+
+        const fheroes2::AGG::ImageCacheStatistics & statistics() const
+        {
+            return _statistics;
+        }
+
+    private:
+        std::vector<uint64_t> _lastAccess;
+        std::vector<size_t> _size;
+        std::vector<bool> _isPinned;
+
+        uint64_t _accessCounter = 0;
+        uint64_t _lastReleaseAccess = 0;
+        size_t _budget = 0;
+
+        fheroes2::AGG::ImageCacheStatistics _statistics;
+
+        void release( const size_t entryId )
+        {
+            if ( entryId < ICN::LASTICN ) {
+                std::vector<fheroes2::Sprite>().swap( _icnVsSprite[entryId] );
+                _icnVsScaledSprite.erase( static_cast<int>( entryId ) );
+            }
+            else {
+                std::vector<std::vector<fheroes2::Image>>().swap( _tilVsImage[entryId - ICN::LASTICN] );
+            }
+
+            updateSize( entryId, 0 );
+            ++_statistics.evictions;
+        }
+    };
+
+    ImageCache imageCache;
+
     fheroes2::Image createDigit( const int32_t width, const int32_t height, const std::vector<fheroes2::Point> & points )
     {
         fheroes2::Image digit( width, height );
@@ -1278,43 +1412,7 @@ namespace fheroes2
     {
         void LoadOriginalICN( int id )
         {
-            const std::vector<uint8_t> & body = ::AGG::ReadChunk( ICN::GetString( id ) );
-
-            if ( body.empty() ) {
-                return;
-            }
-
-            StreamBuf imageStream( body );
-
-            const uint32_t count = imageStream.getLE16();
-            const uint32_t blockSize = imageStream.getLE32();
-            if ( count == 0 || blockSize == 0 ) {
-                return;
-            }
-
-            _icnVsSprite[id].resize( count );
-
-            for ( uint32_t i = 0; i < count; ++i ) {
-                imageStream.seek( headerSize + i * 13 );
-
-                ICNHeader header1;
-                imageStream >> header1;
-
-                uint32_t sizeData = 0;
-                if ( i + 1 != count ) {
-                    ICNHeader header2;
-                    imageStream >> header2;
-                    sizeData = header2.offsetData - header1.offsetData;
-                }
-                else {
-                    sizeData = blockSize - header1.offsetData;
-                }
-
-                const uint8_t * data = body.data() + headerSize + header1.offsetData;
-
-                _icnVsSprite[id][i]
-                    = decodeICNSprite( data, sizeData, header1.width, header1.height, static_cast<int16_t>( header1.offsetX ), static_cast<int16_t>( header1.offsetY ) );
-            }
+            _icnVsSprite[id] = readOriginalICN( id );
         }
 
         // Helper function for LoadModifiedICN
@@ -2481,8 +2579,15 @@ namespace fheroes2
 
         size_t GetMaximumICNIndex( int id )
         {
-            if ( _icnVsSprite[id].empty() && !LoadModifiedICN( id ) ) {
-                LoadOriginalICN( id );
+            if ( !_icnVsSprite[id].empty() ) {
+                imageCache.onHit( id );
+            }
+            else {
+                if ( !LoadModifiedICN( id ) ) {
+                    LoadOriginalICN( id );
+                }
+
+                imageCache.onLoad( id, getMemorySize( _icnVsSprite[id] ) );
             }
 
             return _icnVsSprite[id].size();
@@ -2490,21 +2595,24 @@ namespace fheroes2
 
         size_t GetMaximumTILIndex( int id )
         {
-            if ( _tilVsImage[id].empty() ) {
+            if ( !_tilVsImage[id].empty() ) {
+                imageCache.onHit( ImageCache::getTILEntryId( id ) );
+            }
+            else {
                 _tilVsImage[id].resize( 4 ); // 4 possible sides
 
-                const std::vector<uint8_t> & data = ::AGG::ReadChunk( tilFileName[id] );
-                if ( data.size() < headerSize ) {
+                const fheroes2::AGGFile::FileView data = ::AGG::getChunkView( tilFileName[id] );
+                if ( data.size < headerSize ) {
                     return 0;
                 }
 
-                StreamBuf buffer( data );
+                StreamBuf buffer( data.data, data.size );
 
                 const uint32_t count = buffer.getLE16();
                 const uint32_t width = buffer.getLE16();
                 const uint32_t height = buffer.getLE16();
                 const uint32_t size = width * height;
-                if ( headerSize + count * size != data.size() ) {
+                if ( headerSize + count * size != data.size ) {
                     return 0;
                 }
 
@@ -2515,7 +2623,7 @@ namespace fheroes2
                     Image & tilImage = originalTIL[i];
                     tilImage.resize( width, height );
                     tilImage._disableTransformLayer();
-                    memcpy( tilImage.image(), data.data() + headerSize + i * size, size );
+                    memcpy( tilImage.image(), data.data + headerSize + i * size, size );
                     std::fill( tilImage.transform(), tilImage.transform() + width * height, 0 );
                 }
 
@@ -2530,6 +2638,8 @@ namespace fheroes2
                         currentTIL[i] = Flip( originalTIL[i], horizontalFlip, verticalFlip );
                     }
                 }
+
+                imageCache.onLoad( ImageCache::getTILEntryId( id ), getMemorySize( _tilVsImage[id] ) );
             }
 
             return _tilVsImage[id][0].size();
@@ -2587,6 +2697,13 @@ namespace fheroes2
             return _icnVsSprite[icnId][index];
         }
 
+        void prefetchICN( const int icnId )
+        {
+            if ( IsValidICNId( icnId ) && _icnVsSprite[icnId].empty() ) {
+                prefetchOriginalICN( icnId );
+            }
+        }
+
         uint32_t GetICNCount( int icnId )
         {
             if ( !IsValidICNId( icnId ) ) {
@@ -2750,6 +2867,10 @@ namespace fheroes2
                 alphabetPreserver.preserve();
                 generateAlphabet( language );
             }
+
+            for ( const int icnId : { ICN::FONT, ICN::SMALFONT, ICN::YELLOW_FONT, ICN::YELLOW_SMALLFONT, ICN::GRAY_FONT, ICN::GRAY_SMALL_FONT, ICN::WHITE_LARGE_FONT } ) {
+                imageCache.updateSize( icnId, getMemorySize( _icnVsSprite[icnId] ) );
+            }
         }
 
         bool isAlphabetSupported( const SupportedLanguage language )
@@ -2766,5 +2887,27 @@ namespace fheroes2
 
             return false;
         }
+
+        void setImageCacheBudget( const size_t bytes )
+        {
+            imageCache.setBudget( bytes );
+        }
+
+        void pinICN( const int icnId )
+        {
+            if ( IsValidICNId( icnId ) ) {
+                imageCache.pin( icnId );
+            }
+        }
+
+        void releaseUnusedImages()
+        {
+            imageCache.releaseUnused();
+        }
+
+        const ImageCacheStatistics & getImageCacheStatistics()
+        {
+            return imageCache.statistics();
+        }
     }
 }
@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 namespace fheroes2
@@ -35,6 +36,9 @@ namespace fheroes2
         const Sprite & GetICN( int icnId, uint32_t index );
         uint32_t GetICNCount( int icnId );
 
+        // Starts decoding of the ICN in a background thread if it is not loaded yet. Use it for ICNs which are going to be shown soon.
+        void prefetchICN( const int icnId );
+
         // shapeId could be 0, 1, 2 or 3 only
         const Image & GetTIL( int tilId, uint32_t index, uint32_t shapeId );
         const Sprite & GetLetter( uint32_t character, uint32_t fontType );
@@ -51,5 +55,25 @@ namespace fheroes2
         void updateAlphabet( const SupportedLanguage language, const bool loadOriginalAlphabet );
 
         bool isAlphabetSupported( const SupportedLanguage language );
+
+        struct ImageCacheStatistics
+        {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t evictions = 0;
+            size_t bytesResident = 0;
+        };
+
+        // Sets the memory limit in bytes for decoded ICNs and TILs, 0 means no limit.
+        void setImageCacheBudget( const size_t bytes );
+
+        // Pinned ICNs are never released. Fonts, cursors and adventure map borders are pinned by default.
+        void pinICN( const int icnId );
+
+        // Releases the least recently used ICNs and TILs until their memory fits into the budget. Images used since the previous call are kept.
+        // This function must be called only at the moment when no references returned by GetICN() or GetTIL() are kept by the caller code.
+        void releaseUnusedImages();
+
+        const ImageCacheStatistics & getImageCacheStatistics();
     }
 }
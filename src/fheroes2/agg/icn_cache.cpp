@@ -0,0 +1,563 @@
+/***************************************************************************
+ *   Free Heroes of Might and Magic II: https://github.com/ihhub/fheroes2  *
+ *   Copyright (C) 2021                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "agg.h"
+#include "agg_file.h"
+#include "icn.h"
+#include "icn_cache.h"
+#include "image.h"
+#include "image_tool.h"
+#include "logging.h"
+#include "memory_mapped_file.h"
+#include "serialize.h"
+#include "system.h"
+
+namespace
+{
+    // All values in the cache file are stored in little-endian byte order. The file consists of:
+    // - header: magic number, version, checksum of AGG files (2 values) and the number of ICNs
+    // - table of ICNs: offset and size of the section of ICN from the beginning of the file and the number of sprites
+    // - sections of ICNs: records of sprites (offset X and Y, width, height and offset of pixels from the beginning of the section)
+    //   followed by image and transform layers of every sprite.
+    const uint32_t cacheMagic = 0x4E434946; // 'FICN'
+    const uint32_t cacheFormatVersion = 1;
+    // The cache is rebuilt when either the file format or the output of the decoder changes.
+    const uint32_t cacheVersion = ( cacheFormatVersion << 16 ) | fheroes2::icnSpriteDecoderVersion;
+
+    const size_t cacheHeaderSize = 5 * sizeof( uint32_t );
+    const size_t icnRecordSize = 3 * sizeof( uint32_t );
+    const size_t spriteRecordSize = 5 * sizeof( uint32_t );
+
+    const uint32_t icnHeaderSize = 6;
+
+    const size_t maxPrefetchedIcns = 64;
+
+    std::vector<fheroes2::Sprite> decodeICN( const fheroes2::AGGFile::FileView & body )
+    {
+        if ( body.empty() ) {
+            return std::vector<fheroes2::Sprite>();
+        }
+
+        StreamBuf imageStream( body.data, body.size );
+
+        const uint32_t count = imageStream.getLE16();
+        const uint32_t blockSize = imageStream.getLE32();
+        if ( count == 0 || blockSize == 0 ) {
+            return std::vector<fheroes2::Sprite>();
+        }
+
+        std::vector<fheroes2::Sprite> sprites( count );
+
+        for ( uint32_t i = 0; i < count; ++i ) {
+            imageStream.seek( icnHeaderSize + i * 13 );
+
+            fheroes2::ICNHeader header1;
+            imageStream >> header1;
+
+            uint32_t sizeData = 0;
+            if ( i + 1 != count ) {
+                fheroes2::ICNHeader header2;
+                imageStream >> header2;
+                sizeData = header2.offsetData - header1.offsetData;
+            }
+            else {
+                sizeData = blockSize - header1.offsetData;
+            }
+
+            const uint8_t * data = body.data + icnHeaderSize + header1.offsetData;
+
+            sprites[i] = fheroes2::decodeICNSprite( data, sizeData, header1.width, header1.height, static_cast<int16_t>( header1.offsetX ),
+                                                    static_cast<int16_t>( header1.offsetY ) );
+        }
+
+        return sprites;
+    }
+
+    uint32_t readLE32( const uint8_t * data )
+    {
+        return static_cast<uint32_t>( data[0] ) | ( static_cast<uint32_t>( data[1] ) << 8 ) | ( static_cast<uint32_t>( data[2] ) << 16 )
+               | ( static_cast<uint32_t>( data[3] ) << 24 );
+    }
+
+    void writeLE32( uint8_t * data, const uint32_t value )
+    {
+        data[0] = static_cast<uint8_t>( value );
+        data[1] = static_cast<uint8_t>( value >> 8 );
+        data[2] = static_cast<uint8_t>( value >> 16 );
+        data[3] = static_cast<uint8_t>( value >> 24 );
+    }
+
+    // Returns the section of the cache file for the sprites.
+    std::vector<uint8_t> encodeICNSection( const std::vector<fheroes2::Sprite> & sprites )
+    {
+        size_t sectionSize = sprites.size() * spriteRecordSize;
+        for ( const fheroes2::Sprite & sprite : sprites ) {
+            sectionSize += 2 * static_cast<size_t>( sprite.width() ) * static_cast<size_t>( sprite.height() );
+        }
+
+        std::vector<uint8_t> section( sectionSize );
+
+        uint8_t * record = section.data();
+        uint32_t pixelOffset = static_cast<uint32_t>( sprites.size() * spriteRecordSize );
+        for ( const fheroes2::Sprite & sprite : sprites ) {
+            writeLE32( record, static_cast<uint32_t>( sprite.x() ) );
+            writeLE32( record + 4, static_cast<uint32_t>( sprite.y() ) );
+            writeLE32( record + 8, static_cast<uint32_t>( sprite.width() ) );
+            writeLE32( record + 12, static_cast<uint32_t>( sprite.height() ) );
+            writeLE32( record + 16, pixelOffset );
+            record += spriteRecordSize;
+
+            const size_t layerSize = static_cast<size_t>( sprite.width() ) * static_cast<size_t>( sprite.height() );
+            if ( layerSize > 0 ) {
+                memcpy( section.data() + pixelOffset, sprite.image(), layerSize );
+                memcpy( section.data() + pixelOffset + layerSize, sprite.transform(), layerSize );
+            }
+
+            pixelOffset += static_cast<uint32_t>( 2 * layerSize );
+        }
+
+        return section;
+    }
+
+    struct ICNSection
+    {
+        const uint8_t * data = nullptr;
+        uint32_t size = 0;
+        uint32_t spriteCount = 0;
+    };
+
+    class ICNCache
+    {
+    public:
+        void open( const std::string & fileName, const uint64_t dataChecksum )
+        {
+            _fileName = fileName;
+            _dataChecksum = dataChecksum;
+
+            _newSections.assign( ICN::LASTICN, NewICNSection() );
+            _sections.assign( ICN::LASTICN, ICNSection() );
+
+            if ( !_file.open( fileName ) ) {
+                return;
+            }
+
+            if ( !_readTable() ) {
+                DEBUG_LOG( DBG_ENGINE, DBG_WARN, "ICN cache " << fileName << " is outdated or corrupted" );
+                _sections.assign( ICN::LASTICN, ICNSection() );
+                _file.close();
+            }
+        }
+
+        void close()
+        {
+            if ( _isUpdated ) {
+                _write();
+            }
+
+            _file.close();
+            _sections.clear();
+            _newSections.clear();
+            _isUpdated = false;
+        }
+
+        bool read( const int icnId, std::vector<fheroes2::Sprite> & sprites ) const
+        {
+            if ( icnId < 0 || static_cast<size_t>( icnId ) >= _sections.size() || _sections[icnId].data == nullptr ) {
+                return false;
+            }
+
+            const ICNSection & section = _sections[icnId];
+
+            std::vector<fheroes2::Sprite> output( section.spriteCount );
+
+            const uint8_t * record = section.data;
+            for ( fheroes2::Sprite & sprite : output ) {
+                const int32_t offsetX = static_cast<int32_t>( readLE32( record ) );
+                const int32_t offsetY = static_cast<int32_t>( readLE32( record + 4 ) );
+                const int32_t width = static_cast<int32_t>( readLE32( record + 8 ) );
+                const int32_t height = static_cast<int32_t>( readLE32( record + 12 ) );
+                const uint32_t pixelOffset = readLE32( record + 16 );
+                record += spriteRecordSize;
+
+                if ( width <= 0 || height <= 0 ) {
+                    sprite.setPosition( offsetX, offsetY );
+                    continue;
+                }
+
+                const size_t layerSize = static_cast<size_t>( width ) * static_cast<size_t>( height );
+                if ( width > 0xFFFF || height > 0xFFFF || pixelOffset > section.size || section.size - pixelOffset < 2 * layerSize ) {
+                    return false;
+                }
+
+                sprite = fheroes2::Sprite( width, height, offsetX, offsetY );
+                memcpy( sprite.image(), section.data + pixelOffset, layerSize );
+                memcpy( sprite.transform(), section.data + pixelOffset + layerSize, layerSize );
+            }
+
+            sprites = std::move( output );
+            return true;
+        }
+
+        // Keeps the ICN decoded from AGG files to write it into the cache at exit. Called by the main and the prefetching threads.
+        void add( const int icnId, const std::vector<fheroes2::Sprite> & sprites )
+        {
+            std::lock_guard<std::mutex> guard( _mutex );
+
+            if ( icnId < 0 || static_cast<size_t>( icnId ) >= _newSections.size() || _sections[icnId].data != nullptr || _newSections[icnId].isSet ) {
+                return;
+            }
+
+            // ICNs are not kept in the original state in memory so they are encoded now instead of being decoded again at exit.
+            NewICNSection & section = _newSections[icnId];
+            section.data = encodeICNSection( sprites );
+            section.spriteCount = static_cast<uint32_t>( sprites.size() );
+            section.isSet = true;
+
+            _isUpdated = true;
+        }
+
+    private:
+        struct NewICNSection
+        {
+            std::vector<uint8_t> data;
+            uint32_t spriteCount = 0;
+            bool isSet = false;
+        };
+
+        std::string _fileName;
+        uint64_t _dataChecksum = 0;
+
+        fheroes2::MemoryMappedFile _file;
+        std::vector<ICNSection> _sections;
+
+        // ICNs which were decoded from AGG files during this launch.
+        std::vector<NewICNSection> _newSections;
+        bool _isUpdated = false;
+        std::mutex _mutex;
+
+        bool _readTable()
+        {
+            const uint8_t * data = _file.data();
+            const size_t size = _file.size();
+
+            if ( size < cacheHeaderSize + icnRecordSize * ICN::LASTICN ) {
+                return false;
+            }
+
+            const uint64_t dataChecksum = static_cast<uint64_t>( readLE32( data + 8 ) ) | ( static_cast<uint64_t>( readLE32( data + 12 ) ) << 32 );
+
+            if ( readLE32( data ) != cacheMagic || readLE32( data + 4 ) != cacheVersion || dataChecksum != _dataChecksum
+                 || readLE32( data + 16 ) != static_cast<uint32_t>( ICN::LASTICN ) ) {
+                return false;
+            }
+
+            const uint8_t * record = data + cacheHeaderSize;
+            for ( ICNSection & section : _sections ) {
+                const uint32_t offset = readLE32( record );
+                const uint32_t sectionSize = readLE32( record + 4 );
+                const uint32_t spriteCount = readLE32( record + 8 );
+                record += icnRecordSize;
+
+                if ( offset == 0 ) {
+                    // The ICN is not cached.
+                    continue;
+                }
+
+                if ( offset > size || size - offset < sectionSize || sectionSize / spriteRecordSize < spriteCount ) {
+                    return false;
+                }
+
+                section.data = data + offset;
+                section.size = sectionSize;
+                section.spriteCount = spriteCount;
+            }
+
+            return true;
+        }
+
+        void _write()
+        {
+            // The cache is written into a temporary file first so an interrupted writing doesn't break the existing cache.
+            const std::string tempFileName = _fileName + ".tmp";
+
+            StreamFile stream;
+            if ( !stream.open( tempFileName, "wb" ) ) {
+                ERROR_LOG( "Unable to write ICN cache " << tempFileName );
+                return;
+            }
+
+            stream.putLE32( cacheMagic );
+            stream.putLE32( cacheVersion );
+            stream.putLE32( static_cast<uint32_t>( _dataChecksum ) );
+            stream.putLE32( static_cast<uint32_t>( _dataChecksum >> 32 ) );
+            stream.putLE32( static_cast<uint32_t>( ICN::LASTICN ) );
+
+            // The table is written when all sections are in place.
+            const std::vector<char> emptyTable( icnRecordSize * ICN::LASTICN, 0 );
+            stream.putRaw( emptyTable.data(), emptyTable.size() );
+
+            // Offset, size and the number of sprites for every ICN.
+            std::vector<std::array<uint32_t, 3>> table( ICN::LASTICN, { { 0, 0, 0 } } );
+            size_t offset = cacheHeaderSize + emptyTable.size();
+
+            for ( int id = 0; id < ICN::LASTICN; ++id ) {
+                const uint8_t * sectionData = nullptr;
+                size_t sectionSize = 0;
+
+                if ( _sections[id].data != nullptr ) {
+                    sectionData = _sections[id].data;
+                    sectionSize = _sections[id].size;
+                    table[id][2] = _sections[id].spriteCount;
+                }
+                else if ( _newSections[id].isSet ) {
+                    sectionData = _newSections[id].data.data();
+                    sectionSize = _newSections[id].data.size();
+                    table[id][2] = _newSections[id].spriteCount;
+                }
+                else {
+                    continue;
+                }
+
+                table[id][0] = static_cast<uint32_t>( offset );
+                table[id][1] = static_cast<uint32_t>( sectionSize );
+
+                stream.putRaw( reinterpret_cast<const char *>( sectionData ), sectionSize );
+                offset += sectionSize;
+            }
+
+            stream.seek( cacheHeaderSize );
+            for ( const std::array<uint32_t, 3> & record : table ) {
+                for ( const uint32_t value : record ) {
+                    stream.putLE32( value );
+                }
+            }
+
+            const bool isWritten = !stream.fail();
+            stream.close();
+
+            // The mapping of the old file must be released before the file is replaced.
+            _file.close();
+            _sections.assign( ICN::LASTICN, ICNSection() );
+
+            if ( !isWritten ) {
+                ERROR_LOG( "Unable to write ICN cache " << tempFileName );
+                System::Unlink( tempFileName );
+                return;
+            }
+
+            System::Unlink( _fileName );
+            if ( std::rename( tempFileName.c_str(), _fileName.c_str() ) != 0 ) {
+                ERROR_LOG( "Unable to replace ICN cache " << _fileName );
+                System::Unlink( tempFileName );
+            }
+        }
+    };
+
+    ICNCache icnCache;
+
+    // Decodes ICNs requested by the main thread in advance. Decoded ICNs are kept until the main thread takes them or until they are
+    // evicted by newer predictions.
+    class ICNPrefetcher
+    {
+    public:
+        ICNPrefetcher() = default;
+        ICNPrefetcher( const ICNPrefetcher & ) = delete;
+
+        ~ICNPrefetcher()
+        {
+            stop();
+        }
+
+        ICNPrefetcher & operator=( const ICNPrefetcher & ) = delete;
+
+        void push( const int icnId )
+        {
+            std::lock_guard<std::mutex> guard( _mutex );
+
+            if ( icnId == _currentIcnId || _readyIcns.count( icnId ) > 0 || std::find( _queue.begin(), _queue.end(), icnId ) != _queue.end() ) {
+                return;
+            }
+
+            // Predictions are not always right so the memory used by ICNs which are not taken yet is limited. The oldest predictions
+            // are the most likely to be wrong so they are dropped first.
+            while ( _queue.size() + _readyIcns.size() >= maxPrefetchedIcns ) {
+                if ( !_readyOrder.empty() ) {
+                    _readyIcns.erase( _readyOrder.front() );
+                    _readyOrder.pop_front();
+                }
+                else {
+                    _queue.pop_front();
+                }
+            }
+
+            if ( !_worker ) {
+                _exitFlag = false;
+                _worker.reset( new std::thread( ICNPrefetcher::_workerThread, this ) );
+            }
+
+            _queue.push_back( icnId );
+            _workerNotification.notify_one();
+        }
+
+        // Returns true and decoded sprites if the ICN was prefetched. If the ICN is being decoded at the moment the call waits for the result.
+        bool take( const int icnId, std::vector<fheroes2::Sprite> & sprites )
+        {
+            std::unique_lock<std::mutex> mutexLock( _mutex );
+
+            // There is no point to wait for ICNs which are not decoded yet.
+            _queue.erase( std::remove( _queue.begin(), _queue.end(), icnId ), _queue.end() );
+
+            _masterNotification.wait( mutexLock, [this, icnId] { return _currentIcnId != icnId; } );
+
+            auto iter = _readyIcns.find( icnId );
+            if ( iter == _readyIcns.end() ) {
+                return false;
+            }
+
+            sprites = std::move( iter->second );
+            _readyIcns.erase( iter );
+            _readyOrder.erase( std::find( _readyOrder.begin(), _readyOrder.end(), icnId ) );
+            return true;
+        }
+
+        void stop()
+        {
+            if ( !_worker ) {
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> guard( _mutex );
+                _exitFlag = true;
+                _workerNotification.notify_one();
+            }
+
+            _worker->join();
+            _worker.reset();
+
+            _queue.clear();
+            _readyIcns.clear();
+            _readyOrder.clear();
+        }
+
+    private:
+        std::unique_ptr<std::thread> _worker;
+        std::mutex _mutex;
+
+        std::condition_variable _workerNotification;
+        std::condition_variable _masterNotification;
+
+        std::deque<int> _queue;
+        std::map<int, std::vector<fheroes2::Sprite>> _readyIcns;
+        // Ready ICNs from the oldest to the newest.
+        std::deque<int> _readyOrder;
+        int _currentIcnId = -1;
+        bool _exitFlag = false;
+
+        static void _workerThread( ICNPrefetcher * prefetcher )
+        {
+            assert( prefetcher != nullptr );
+
+            std::unique_lock<std::mutex> mutexLock( prefetcher->_mutex );
+
+            while ( true ) {
+                prefetcher->_workerNotification.wait( mutexLock, [prefetcher] { return prefetcher->_exitFlag || !prefetcher->_queue.empty(); } );
+
+                if ( prefetcher->_exitFlag ) {
+                    break;
+                }
+
+                const int icnId = prefetcher->_queue.front();
+                prefetcher->_queue.pop_front();
+                prefetcher->_currentIcnId = icnId;
+
+                mutexLock.unlock();
+
+                std::vector<fheroes2::Sprite> sprites;
+                if ( !icnCache.read( icnId, sprites ) ) {
+                    sprites = decodeICN( ::AGG::getChunkView( ICN::GetString( icnId ) ) );
+                    icnCache.add( icnId, sprites );
+                }
+
+                mutexLock.lock();
+
+                prefetcher->_readyIcns.emplace( icnId, std::move( sprites ) );
+                prefetcher->_readyOrder.push_back( icnId );
+                prefetcher->_currentIcnId = -1;
+                prefetcher->_masterNotification.notify_all();
+            }
+        }
+    };
+
+    ICNPrefetcher icnPrefetcher;
+}
+
+namespace fheroes2
+{
+    namespace AGG
+    {
+        void openICNCache( const std::string & fileName, const uint64_t dataChecksum )
+        {
+#if defined( FHEROES2_VITA ) || defined( __SWITCH__ )
+            // Files cannot be mapped into memory on these platforms so the whole cache would have to be read into memory.
+            (void)fileName;
+            (void)dataChecksum;
+#else
+            icnCache.open( fileName, dataChecksum );
+#endif
+        }
+
+        void closeICNCache()
+        {
+            // The prefetching thread reads the cache so it must be stopped first.
+            icnPrefetcher.stop();
+            icnCache.close();
+        }
+
+        void prefetchOriginalICN( const int icnId )
+        {
+            icnPrefetcher.push( icnId );
+        }
+
+        std::vector<Sprite> readOriginalICN( const int icnId )
+        {
+            std::vector<Sprite> sprites;
+
+            if ( !icnPrefetcher.take( icnId, sprites ) && !icnCache.read( icnId, sprites ) ) {
+                sprites = decodeICN( ::AGG::getChunkView( ICN::GetString( icnId ) ) );
+                icnCache.add( icnId, sprites );
+            }
+
+            return sprites;
+        }
+    }
+}
@@ -0,0 +1,46 @@
+/***************************************************************************
+ *   Free Heroes of Might and Magic II: https://github.com/ihhub/fheroes2  *
+ *   Copyright (C) 2021                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fheroes2
+{
+    class Sprite;
+
+    namespace AGG
+    {
+        // Original ICN sprites are decoded from AGG files only once: at exit the game writes all decoded ICNs into a cache file
+        // which is mapped into memory at the next launch. The cache is ignored if it was created for other AGG files.
+        void openICNCache( const std::string & fileName, const uint64_t dataChecksum );
+
+        // Writes the cache file again if some ICNs were not found in it.
+        void closeICNCache();
+
+        // Starts decoding of the original ICN in a background thread. The result is used by readOriginalICN.
+        void prefetchOriginalICN( const int icnId );
+
+        // Returns sprites of the original ICN prefetched, from the cache or decoded from AGG files.
+        std::vector<Sprite> readOriginalICN( const int icnId );
+    }
+}
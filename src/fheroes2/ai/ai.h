@@ -101,6 +101,7 @@ namespace AI
 
         virtual void Reset();
         virtual void resetPathfinder() = 0;
+        virtual void invalidatePathfinderTile( const int32_t tileIndex ) = 0;
 
         virtual ~Base() = default;
 
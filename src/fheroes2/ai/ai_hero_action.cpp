@@ -70,7 +70,7 @@ namespace
     // Never cache the value of this function as it depends on hero's path and location.
     bool AIHeroesShowAnimation( const Heroes & hero, const uint32_t colors )
     {
-        if ( Settings::Get().AIMoveSpeed() == 0 ) {
+        if ( Game::isHeadless() || Settings::Get().AIMoveSpeed() == 0 ) {
             return false;
         }
 
@@ -1639,12 +1639,13 @@ namespace AI
             fheroes2::Point heroAnimationOffset;
             int heroAnimationSpriteId = 0;
 
-            const bool hideAIMovements = ( conf.AIMoveSpeed() == 0 );
+            const bool hideAIMovements = ( Game::isHeadless() || conf.AIMoveSpeed() == 0 );
             const bool noMovementAnimation = ( conf.AIMoveSpeed() == 10 );
 
             const std::vector<Game::DelayType> delayTypes = { Game::CURRENT_AI_DELAY };
 
-            while ( LocalEvent::Get().HandleEvents( !hideAIMovements && Game::isDelayNeeded( delayTypes ) ) ) {
+            // there is no event processing in headless mode
+            while ( Game::isHeadless() || LocalEvent::Get().HandleEvents( !hideAIMovements && Game::isDelayNeeded( delayTypes ) ) ) {
                 if ( hero.isFreeman() || !hero.isMoveEnabled() ) {
                     break;
                 }
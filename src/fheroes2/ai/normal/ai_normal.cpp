@@ -25,14 +25,24 @@
 namespace AI
 {
     Normal::Normal()
-        : _pathfinder( ARMY_STRENGTH_ADVANTAGE_LARGE )
+        : _heroPathfinders( ARMY_STRENGTH_ADVANTAGE_LARGE )
+        , _threatDistances( ARMY_STRENGTH_ADVANTAGE_LARGE )
     {
         _personality = Rand::Get( AI::WARRIOR, AI::EXPLORER );
     }
 
     void Normal::resetPathfinder()
     {
-        _pathfinder.reset();
+        _heroPathfinders.reset();
+        _threatDistances.reset();
+        _objectScan.reset();
+    }
+
+    void Normal::invalidatePathfinderTile( const int32_t tileIndex )
+    {
+        _heroPathfinders.invalidateTile( tileIndex );
+        _threatDistances.invalidateTile( tileIndex );
+        _objectScan.invalidateTile( tileIndex );
     }
 
     void Normal::revealFog( const Maps::Tiles & tile )
@@ -71,6 +71,35 @@ namespace AI
         }
     };
 
+    // Color independent part of the map scan done at the start of every kingdom turn. It is shared by all AI kingdoms
+    // during the day and only the tiles changed since the last scan are updated.
+    class KingdomObjectScan
+    {
+    public:
+        struct Object
+        {
+            int32_t index = -1;
+            MP2::MapObjectType type = MP2::OBJ_ZERO;
+            uint32_t regionId = 0;
+            // Strength of the monster army, 0 for other objects
+            double monsterStrength = 0;
+        };
+
+        // Updates the outdated objects and returns all action objects and coasts sorted by tile index
+        const std::vector<Object> & update();
+
+        void reset();
+        void invalidateTile( const int32_t tileIndex );
+
+    private:
+        static bool getObject( const int32_t tileIndex, Object & object );
+
+        std::vector<Object> _objects;
+        std::vector<int32_t> _outdatedTiles;
+        uint32_t _day = 0;
+        bool _isFullUpdateNeeded = true;
+    };
+
     class BattlePlanner
     {
     public:
@@ -138,13 +167,16 @@ namespace AI
         double getObjectValue( const Heroes & hero, const int index, const double valueToIgnore, const uint32_t distanceToObject ) const;
         int getPriorityTarget( const Heroes & hero, double & maxPriority, int patrolIndex = -1, uint32_t distanceLimit = 0 );
         void resetPathfinder() override;
+        void invalidatePathfinderTile( const int32_t tileIndex ) override;
 
     private:
         // following data won't be saved/serialized
         double _combinedHeroStrength = 0;
         std::vector<IndexObject> _mapObjects;
         std::vector<RegionStats> _regions;
-        AIWorldPathfinder _pathfinder;
+        AIHeroPathfinders _heroPathfinders;
+        AIDistanceMatrix _threatDistances;
+        KingdomObjectScan _objectScan;
         BattlePlanner _battlePlanner;
 
         double getHunterObjectValue( const Heroes & hero, const int index, const double valueToIgnore, const uint32_t distanceToObject ) const;
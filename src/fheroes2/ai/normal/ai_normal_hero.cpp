@@ -48,6 +48,13 @@ namespace
         return false;
     }
 
+    // The same as army.isStrongerThan( Army( tile ), safetyRatio ) without creating the guard army
+    bool isStrongerThanGuard( const Army & army, const int32_t index, const double safetyRatio )
+    {
+        const double guardStrength = world.getPathfindingSnapshot().getGuardStrength( index );
+        return guardStrength <= 0 || army.GetStrength() > guardStrength * safetyRatio;
+    }
+
     bool HeroesValidObject( const Heroes & hero, const int32_t index, const AIWorldPathfinder & pathfinder )
     {
         const Maps::Tiles & tile = world.GetTiles( index );
@@ -303,7 +310,7 @@ namespace
         case MP2::OBJ_CITYDEAD:
         case MP2::OBJ_TROLLBRIDGE: {
             if ( Color::NONE == tile.QuantityColor() ) {
-                return army.isStrongerThan( Army( tile ), AI::ARMY_STRENGTH_ADVANTAGE_MEDUIM );
+                return isStrongerThanGuard( army, index, AI::ARMY_STRENGTH_ADVANTAGE_MEDUIM );
             }
             else {
                 const Troop & troop = tile.QuantityTroop();
@@ -364,11 +371,11 @@ namespace
 
         case MP2::OBJ_DAEMONCAVE:
             if ( tile.QuantityIsValid() && 4 != tile.QuantityVariant() )
-                return army.isStrongerThan( Army( tile ), AI::ARMY_STRENGTH_ADVANTAGE_MEDUIM );
+                return isStrongerThanGuard( army, index, AI::ARMY_STRENGTH_ADVANTAGE_MEDUIM );
             break;
 
         case MP2::OBJ_MONSTER:
-            return army.isStrongerThan( Army( tile ), AI::ARMY_STRENGTH_ADVANTAGE_MEDUIM );
+            return isStrongerThanGuard( army, index, AI::ARMY_STRENGTH_ADVANTAGE_MEDUIM );
 
         case MP2::OBJ_SIGN:
             // AI has no brains to process anything from sign messages.
@@ -1071,11 +1078,12 @@ namespace AI
 #endif
 
         // pre-cache the pathfinder
-        _pathfinder.reEvaluateIfNeeded( hero );
+        AIWorldPathfinder & pathfinder = _heroPathfinders.get( hero );
+        pathfinder.reEvaluateIfNeeded( hero );
 
         const uint32_t leftMovePoints = hero.GetMovePoints();
 
-        ObjectValidator objectValidator( hero, _pathfinder );
+        ObjectValidator objectValidator( hero, pathfinder );
         ObjectValueStorage valueStorage( hero, *this, lowestPossibleValue );
 
         for ( size_t idx = 0; idx < _mapObjects.size(); ++idx ) {
@@ -1086,13 +1094,13 @@ namespace AI
                 continue;
 
             if ( objectValidator.isValid( node.first ) ) {
-                uint32_t dist = _pathfinder.getDistance( node.first );
+                uint32_t dist = pathfinder.getDistance( node.first );
                 if ( dist == 0 )
                     continue;
 
                 double value = valueStorage.value( node, dist );
 
-                const std::vector<IndexObject> & list = _pathfinder.getObjectsOnTheWay( node.first );
+                const std::vector<IndexObject> & list = pathfinder.getObjectsOnTheWay( node.first );
                 for ( const IndexObject & pair : list ) {
                     if ( objectValidator.isValid( pair.first ) && std::binary_search( _mapObjects.begin(), _mapObjects.end(), pair ) ) {
                         const double extraValue = valueStorage.value( pair, 0 ); // object is on the way, we don't loose any movement points.
@@ -1139,7 +1147,7 @@ namespace AI
                        hero.GetName() << ": priority selected: " << priorityTarget << " value is " << maxPriority << " (" << MP2::StringObject( objectType ) << ")" );
         }
         else if ( !heroInPatrolMode ) {
-            priorityTarget = _pathfinder.getFogDiscoveryTile( hero );
+            priorityTarget = pathfinder.getFogDiscoveryTile( hero );
             DEBUG_LOG( DBG_AI, DBG_INFO, hero.GetName() << " can't find an object. Scouting the fog of war at " << priorityTarget );
         }
 
@@ -1167,7 +1175,7 @@ namespace AI
             addHeroToMove( hero, availableHeroes );
         }
 
-        const double originalMonsterStrengthMultipler = _pathfinder.getCurrentArmyStrengthMultiplier();
+        const double originalMonsterStrengthMultipler = _heroPathfinders.getCurrentArmyStrengthMultiplier();
 
         const int monsterStrengthMultiplierCount = 2;
         const double monsterStrengthMultipliers[monsterStrengthMultiplierCount] = { ARMY_STRENGTH_ADVANTAGE_MEDUIM, ARMY_STRENGTH_ADVANTAGE_SMALL };
@@ -1178,6 +1186,18 @@ namespace AI
             int bestTargetIndex = -1;
 
             while ( true ) {
+                // Nothing changes on the map while targets are evaluated so the strength of every army is calculated only once.
+                const ArmyStrengthCacheScope strengthCacheScope;
+
+                // Paths of all heroes are independent so they are evaluated at once
+                std::vector<const Heroes *> heroesToEvaluate;
+                heroesToEvaluate.reserve( availableHeroes.size() );
+                for ( const HeroToMove & heroInfo : availableHeroes ) {
+                    heroesToEvaluate.push_back( heroInfo.hero );
+                }
+
+                _heroPathfinders.reEvaluateIfNeeded( heroesToEvaluate );
+
                 for ( const HeroToMove & heroInfo : availableHeroes ) {
                     double priority = -1;
                     const int targetIndex = getPriorityTarget( *heroInfo.hero, priority, heroInfo.patrolCenter, heroInfo.patrolDistance );
@@ -1193,11 +1213,11 @@ namespace AI
                 }
 
                 // If nowhere to move perhaps it's because of high monster estimation. Let's reduce it.
-                const double currentMonsterStrengthMultipler = _pathfinder.getCurrentArmyStrengthMultiplier();
+                const double currentMonsterStrengthMultipler = _heroPathfinders.getCurrentArmyStrengthMultiplier();
                 bool setNewMultipler = false;
                 for ( int i = 0; i < monsterStrengthMultiplierCount; ++i ) {
                     if ( currentMonsterStrengthMultipler > monsterStrengthMultipliers[i] ) {
-                        _pathfinder.setArmyStrengthMultplier( monsterStrengthMultipliers[i] );
+                        _heroPathfinders.setArmyStrengthMultplier( monsterStrengthMultipliers[i] );
                         setNewMultipler = true;
                         break;
                     }
@@ -1217,11 +1237,12 @@ namespace AI
                             continue;
                         }
 
-                        if ( !_pathfinder.isHeroPossiblyBlockingWay( *heroInfo.hero ) ) {
+                        AIWorldPathfinder & pathfinder = _heroPathfinders.get( *heroInfo.hero );
+                        if ( !pathfinder.isHeroPossiblyBlockingWay( *heroInfo.hero ) ) {
                             continue;
                         }
 
-                        const int targetIndex = _pathfinder.getNeareastTileToMove( *heroInfo.hero );
+                        const int targetIndex = pathfinder.getNeareastTileToMove( *heroInfo.hero );
                         if ( targetIndex != -1 ) {
                             bestTargetIndex = targetIndex;
                             bestHero = heroInfo.hero;
@@ -1232,13 +1253,14 @@ namespace AI
 
                 if ( bestTargetIndex == -1 ) {
                     // Nothing to do. Stop everything
-                    _pathfinder.setArmyStrengthMultplier( originalMonsterStrengthMultipler );
+                    _heroPathfinders.setArmyStrengthMultplier( originalMonsterStrengthMultipler );
                     break;
                 }
             }
 
-            _pathfinder.reEvaluateIfNeeded( *bestHero );
-            bestHero->GetPath().setPath( _pathfinder.buildPath( bestTargetIndex ), bestTargetIndex );
+            AIWorldPathfinder & pathfinder = _heroPathfinders.get( *bestHero );
+            pathfinder.reEvaluateIfNeeded( *bestHero );
+            bestHero->GetPath().setPath( pathfinder.buildPath( bestTargetIndex ), bestTargetIndex );
 
             const size_t heroesBefore = heroes.size();
 
@@ -1258,7 +1280,7 @@ namespace AI
                 ++i;
             }
 
-            _pathfinder.setArmyStrengthMultplier( originalMonsterStrengthMultipler );
+            _heroPathfinders.setArmyStrengthMultplier( originalMonsterStrengthMultipler );
         }
 
         const bool allHeroesMoved = availableHeroes.empty();
@@ -1269,7 +1291,7 @@ namespace AI
             }
         }
 
-        _pathfinder.setArmyStrengthMultplier( originalMonsterStrengthMultipler );
+        _heroPathfinders.setArmyStrengthMultplier( originalMonsterStrengthMultipler );
 
         return allHeroesMoved;
     }
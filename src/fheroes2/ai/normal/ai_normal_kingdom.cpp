@@ -18,6 +18,7 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
+#include <algorithm>
 #include <cassert>
 
 #include "agg.h"
@@ -70,6 +71,91 @@ namespace
 
 namespace AI
 {
+    bool KingdomObjectScan::getObject( const int32_t tileIndex, Object & object )
+    {
+        const Maps::Tiles & tile = world.GetTiles( tileIndex );
+        const MP2::MapObjectType objectType = tile.GetObject();
+
+        // Only action objects and coasts can be valid kingdom objects
+        if ( !MP2::isActionObject( objectType ) && objectType != MP2::OBJ_COAST ) {
+            return false;
+        }
+
+        object.index = tileIndex;
+        object.type = objectType;
+        object.regionId = tile.GetRegion();
+        object.monsterStrength = objectType == MP2::OBJ_MONSTER ? world.getPathfindingSnapshot().getGuardStrength( tileIndex ) : 0;
+        return true;
+    }
+
+    const std::vector<KingdomObjectScan::Object> & KingdomObjectScan::update()
+    {
+        const uint32_t day = world.CountDay();
+
+        if ( _isFullUpdateNeeded || _day != day ) {
+            _objects.clear();
+
+            Object object;
+            for ( const int32_t idx : world.getObjectIndex().getObjects(
+                      []( const MP2::MapObjectType objectType ) { return MP2::isActionObject( objectType ) || objectType == MP2::OBJ_COAST; } ) ) {
+                if ( getObject( idx, object ) ) {
+                    _objects.push_back( object );
+                }
+            }
+
+            _outdatedTiles.clear();
+            _day = day;
+            _isFullUpdateNeeded = false;
+            return _objects;
+        }
+
+        if ( _outdatedTiles.empty() ) {
+            return _objects;
+        }
+
+        std::sort( _outdatedTiles.begin(), _outdatedTiles.end() );
+        _outdatedTiles.erase( std::unique( _outdatedTiles.begin(), _outdatedTiles.end() ), _outdatedTiles.end() );
+
+        _objects.erase( std::remove_if( _objects.begin(), _objects.end(),
+                                        [this]( const Object & object ) { return std::binary_search( _outdatedTiles.begin(), _outdatedTiles.end(), object.index ); } ),
+                        _objects.end() );
+
+        Object object;
+        for ( const int32_t idx : _outdatedTiles ) {
+            if ( getObject( idx, object ) ) {
+                _objects.push_back( object );
+            }
+        }
+
+        // Keep the order of the full scan
+        std::sort( _objects.begin(), _objects.end(), []( const Object & first, const Object & second ) { return first.index < second.index; } );
+
+        _outdatedTiles.clear();
+        return _objects;
+    }
+
+    void KingdomObjectScan::reset()
+    {
+        _objects.clear();
+        _outdatedTiles.clear();
+        _isFullUpdateNeeded = true;
+    }
+
+    void KingdomObjectScan::invalidateTile( const int32_t tileIndex )
+    {
+        if ( _isFullUpdateNeeded ) {
+            return;
+        }
+
+        // Too many changes, it is cheaper to scan all objects again
+        if ( _outdatedTiles.size() >= _objects.size() / 4 + 1 ) {
+            reset();
+            return;
+        }
+
+        _outdatedTiles.push_back( tileIndex );
+    }
+
     void Normal::KingdomTurn( Kingdom & kingdom )
     {
         const int color = kingdom.GetColor();
@@ -94,19 +180,22 @@ namespace AI
         // Step 1. Scan visible map (based on game difficulty), add goals and threats
         std::vector<std::pair<int, const Army *> > enemyArmies;
 
-        const int mapSize = world.w() * world.h();
         _mapObjects.clear();
         _regions.clear();
         _regions.resize( world.getRegionCount() );
 
-        for ( int idx = 0; idx < mapSize; ++idx ) {
+        // Monster strength is taken from the snapshot
+        world.updatePathfindingSnapshot();
+
+        for ( const KingdomObjectScan::Object & object : _objectScan.update() ) {
+            const int32_t idx = object.index;
             const Maps::Tiles & tile = world.GetTiles( idx );
-            const MP2::MapObjectType objectType = tile.GetObject();
+            const MP2::MapObjectType objectType = object.type;
 
             if ( !kingdom.isValidKingdomObject( tile, objectType ) )
                 continue;
 
-            const uint32_t regionID = tile.GetRegion();
+            const uint32_t regionID = object.regionId;
             if ( regionID >= _regions.size() ) {
                 // shouldn't be possible, assert
                 assert( regionID < _regions.size() );
@@ -153,7 +242,7 @@ namespace AI
                     }
                 }
                 else if ( objectType == MP2::OBJ_MONSTER ) {
-                    stats.averageMonster += Army( tile ).GetStrength();
+                    stats.averageMonster += object.monsterStrength;
                     ++stats.monsterCount;
                 }
             }
@@ -178,31 +267,88 @@ namespace AI
         const uint32_t threatDistanceLimit = 2500; // 25 tiles, roughly how much maxed out hero can move in a turn
         std::set<int> castlesInDanger;
 
+        // Collect all pairs of enemy armies and castles which need the precise distance check to calculate them at once
+        std::vector<std::pair<int, double>> attackers;
+        std::vector<int> castleIndexes;
+        std::vector<double> castleDefenders;
+
+        for ( const Castle * castle : castles ) {
+            if ( castle ) {
+                castleIndexes.push_back( castle->GetIndex() );
+                castleDefenders.push_back( castle->GetArmy().GetStrength() );
+            }
+        }
+
         for ( auto enemy = enemyArmies.begin(); enemy != enemyArmies.end(); ++enemy ) {
-            if ( enemy->second == nullptr )
-                continue;
+            if ( enemy->second != nullptr ) {
+                attackers.emplace_back( enemy->first, enemy->second->GetStrength() );
+            }
+        }
 
-            const double attackerStrength = enemy->second->GetStrength();
+        std::vector<bool> threatsToCheck( attackers.size() * castleIndexes.size(), false );
 
-            for ( size_t idx = 0; idx < castles.size(); ++idx ) {
-                const Castle * castle = castles[idx];
-                if ( castle ) {
-                    const int castleIndex = castle->GetIndex();
-                    // skip precise distance check if army is too far away to be a threat
-                    if ( Maps::GetApproximateDistance( enemy->first, castleIndex ) * Maps::Ground::roadPenalty > threatDistanceLimit )
-                        continue;
+        // The region graph can overestimate the distance (the path goes through a single entrance per border segment) so only the pairs
+        // which are much further than the limit are skipped. No path in the graph does not prove that the castle is unreachable.
+        const uint32_t regionThreatDistanceLimit = 2 * threatDistanceLimit;
+        RegionPathfinder & regionPathfinder = world.getRegionPathfinder();
 
-                    const double defenders = castle->GetArmy().GetStrength();
+#ifdef WITH_DEBUG
+        std::vector<size_t> pairsSkippedByRegions;
+#endif
 
-                    const double attackerThreat = attackerStrength - defenders;
-                    if ( attackerThreat > 0 ) {
-                        const uint32_t dist = _pathfinder.getDistance( enemy->first, castleIndex, color, attackerStrength );
-                        if ( dist && dist < threatDistanceLimit ) {
-                            // castle is under threat
-                            castlesInDanger.insert( castleIndex );
-                        }
-                    }
+        for ( size_t attackerId = 0; attackerId < attackers.size(); ++attackerId ) {
+            const int attackerIndex = attackers[attackerId].first;
+
+            for ( size_t castleId = 0; castleId < castleIndexes.size(); ++castleId ) {
+                const int castleIndex = castleIndexes[castleId];
+                // skip precise distance check if army is too far away to be a threat
+                if ( Maps::GetApproximateDistance( attackerIndex, castleIndex ) * Maps::Ground::roadPenalty > threatDistanceLimit )
+                    continue;
+
+                const double attackerThreat = attackers[attackerId].second - castleDefenders[castleId];
+                if ( attackerThreat <= 0 ) {
+                    continue;
+                }
+
+                // Close in a straight line but far away by land or by sea, like the other side of a mountain range or a lake
+                if ( regionPathfinder.getDistance( attackerIndex, castleIndex ) > regionThreatDistanceLimit ) {
+#ifdef WITH_DEBUG
+                    pairsSkippedByRegions.push_back( attackerId * castleIndexes.size() + castleId );
+#endif
+                    continue;
                 }
+
+                threatsToCheck[attackerId * castleIndexes.size() + castleId] = true;
+            }
+        }
+
+        const std::vector<uint32_t> threatDistances = _threatDistances.calculate( attackers, castleIndexes, threatsToCheck, color );
+
+#ifdef WITH_DEBUG
+        if ( IS_DEVEL() && !pairsSkippedByRegions.empty() ) {
+            // Self-check: the pairs skipped by the region graph must not be threats according to the precise distance
+            AIWorldPathfinder pathfinder( ARMY_STRENGTH_ADVANTAGE_LARGE );
+            pathfinder.reset();
+
+            for ( const size_t pairId : pairsSkippedByRegions ) {
+                const int attackerIndex = attackers[pairId / castleIndexes.size()].first;
+                const int castleIndex = castleIndexes[pairId % castleIndexes.size()];
+
+                const uint32_t dist = pathfinder.getDistance( attackerIndex, castleIndex, color, attackers[pairId / castleIndexes.size()].second );
+                if ( dist && dist < threatDistanceLimit ) {
+                    DEBUG_LOG( DBG_AI, DBG_WARN,
+                               "Region graph skipped the threat from " << attackerIndex << " to castle " << castleIndex << ", region distance: "
+                                                                       << regionPathfinder.getDistance( attackerIndex, castleIndex ) << ", precise distance: " << dist );
+                }
+            }
+        }
+#endif
+
+        for ( size_t pairId = 0; pairId < threatDistances.size(); ++pairId ) {
+            const uint32_t dist = threatDistances[pairId];
+            if ( dist && dist < threatDistanceLimit ) {
+                // castle is under threat
+                castlesInDanger.insert( castleIndexes[pairId % castleIndexes.size()] );
             }
         }
 
@@ -21,6 +21,7 @@
  ***************************************************************************/
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <numeric>
 
@@ -50,6 +51,16 @@
 #include "translations.h"
 #include "world.h"
 
+namespace
+{
+    // Identifier of the current strength cache scope, 0 if there is no scope.
+    std::atomic<uint32_t> currentStrengthCacheScopeId{ 0 };
+
+    // Scopes are created only by the main thread.
+    uint32_t strengthCacheScopeCount = 0;
+    uint32_t lastStrengthCacheScopeId = 0;
+}
+
 enum armysize_t
 {
     ARMY_FEW = 1,
@@ -921,7 +932,8 @@ void Army::setFromTile( const Maps::Tiles & tile )
 
     default:
         if ( isCaptureObject ) {
-            CapturedObject & co = world.GetCapturedObject( tile.GetIndex() );
+            // Read-only access: armies are created from tiles by the pathfinders running in parallel
+            const CapturedObject & co = static_cast<const World &>( world ).GetCapturedObject( tile.GetIndex() );
             const Troop & troop = co.GetTroop();
 
             switch ( co.GetSplit() ) {
@@ -1069,7 +1081,66 @@ int Army::GetMoraleModificator( std::string * strs ) const
     return result;
 }
 
+ArmyStrengthCacheScope::ArmyStrengthCacheScope()
+{
+    if ( strengthCacheScopeCount++ > 0 ) {
+        return;
+    }
+
+    // Every new scope invalidates the strength calculated before.
+    ++lastStrengthCacheScopeId;
+    if ( lastStrengthCacheScopeId == 0 ) {
+        ++lastStrengthCacheScopeId;
+    }
+
+    currentStrengthCacheScopeId = lastStrengthCacheScopeId;
+}
+
+ArmyStrengthCacheScope::~ArmyStrengthCacheScope()
+{
+    if ( --strengthCacheScopeCount == 0 ) {
+        currentStrengthCacheScopeId = 0;
+    }
+}
+
 double Army::GetStrength() const
+{
+    const uint32_t scopeId = currentStrengthCacheScopeId;
+    if ( scopeId == 0 || size() > ARMYMAXTROOPS ) {
+        return calculateStrength();
+    }
+
+    std::array<std::pair<int, uint32_t>, ARMYMAXTROOPS> troops;
+    troops.fill( std::make_pair( Monster::UNKNOWN, 0 ) );
+
+    for ( size_t i = 0; i < size(); ++i ) {
+        const Troop * troop = at( i );
+        if ( troop != nullptr && troop->isValid() ) {
+            troops[i] = std::make_pair( troop->GetID(), troop->GetCount() );
+        }
+    }
+
+    {
+        const std::lock_guard<std::mutex> lock( _strengthCacheMutex );
+
+        if ( _strengthCache.scopeId == scopeId && _strengthCache.commander == commander && _strengthCache.troops == troops ) {
+            return _strengthCache.strength;
+        }
+    }
+
+    const double strength = calculateStrength();
+
+    const std::lock_guard<std::mutex> lock( _strengthCacheMutex );
+
+    _strengthCache.scopeId = scopeId;
+    _strengthCache.commander = commander;
+    _strengthCache.troops = troops;
+    _strengthCache.strength = strength;
+
+    return strength;
+}
+
+double Army::calculateStrength() const
 {
     double result = 0;
     const uint32_t archery = ( commander ) ? commander->GetSecondaryValues( Skill::Secondary::ARCHERY ) : 0;
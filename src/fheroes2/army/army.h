@@ -23,9 +23,12 @@
 #ifndef H2ARMY_H
 #define H2ARMY_H
 
+#include <array>
+#include <mutex>
 #include <string>
 #include <vector>
 
+#include "gamedefs.h"
 #include "monster.h"
 #include "players.h"
 
@@ -123,6 +126,20 @@ struct NeutralMonsterJoiningCondition
     const char * fleeingMessage;
 };
 
+// While an object of this class exists the strength of every army is calculated only once for its current troops.
+// Commanders, their skills, artifacts and other modifiers of morale and luck must not change during this time.
+// Scopes can be nested and must be created by the main thread.
+class ArmyStrengthCacheScope
+{
+public:
+    ArmyStrengthCacheScope();
+    ArmyStrengthCacheScope( const ArmyStrengthCacheScope & ) = delete;
+
+    ~ArmyStrengthCacheScope();
+
+    ArmyStrengthCacheScope & operator=( const ArmyStrengthCacheScope & ) = delete;
+};
+
 class Army : public Troops, public Control
 {
 public:
@@ -196,6 +213,21 @@ protected:
     HeroBase * commander;
     bool combat_format;
     int color;
+
+private:
+    struct StrengthCache
+    {
+        uint32_t scopeId = 0;
+        const HeroBase * commander = nullptr;
+        std::array<std::pair<int, uint32_t>, ARMYMAXTROOPS> troops;
+        double strength = 0;
+    };
+
+    double calculateStrength() const;
+
+    // Strength is requested by several threads of AI at once.
+    mutable std::mutex _strengthCacheMutex;
+    mutable StrengthCache _strengthCache;
 };
 
 StreamBase & operator<<( StreamBase &, const Army & );
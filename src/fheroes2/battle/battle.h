@@ -68,6 +68,9 @@ namespace Battle
 
     Result Loader( Army &, Army &, s32 );
 
+    // Returns ICNs of the battlefield cover and its frame for a battle on the given tile.
+    std::pair<int, int> getBattlefieldCoverICNs( const int32_t tileIndex );
+
     struct TargetInfo
     {
         Unit * defender;
@@ -157,6 +157,11 @@ Battle::Interface * Battle::Arena::GetInterface( void )
     return arena->interface;
 }
 
+bool Battle::Arena::isComputeOnly()
+{
+    return arena != nullptr && arena->_isComputeOnly;
+}
+
 Battle::Tower * Battle::Arena::GetTower( int type )
 {
     switch ( type ) {
@@ -180,6 +185,7 @@ Battle::Arena::Arena( Army & a1, Army & a2, s32 index, bool local, Rand::Determi
     , preferredColor( -1 ) // be aware of unknown color
     , castle( world.getCastleEntrance( Maps::GetPoint( index ) ) )
     , _isTown( castle != nullptr )
+    , _isComputeOnly( !local )
     , catapult( nullptr )
     , bridge( nullptr )
     , interface( nullptr )
@@ -169,6 +169,9 @@ namespace Battle
         static Interface * GetInterface( void );
         static Graveyard * GetGraveyard( void );
 
+        // Returns true if the current battle has no interface so only the battle logic should be calculated.
+        static bool isComputeOnly();
+
         enum
         {
             CATAPULT_POS = 77,
@@ -229,6 +232,7 @@ namespace Battle
 
         const Castle * castle;
         const bool _isTown; // If the battle is in town (village or castle).
+        const bool _isComputeOnly; // No interface, animations or sounds.
 
         Tower * towers[3];
         Catapult * catapult;
@@ -24,7 +24,9 @@
 #include <array>
 #include <cassert>
 #include <cstdint>
+#include <deque>
 #include <iterator>
+#include <limits>
 #include <set>
 
 #include "battle_arena.h"
@@ -180,274 +182,214 @@ uint32_t Battle::Board::GetDistance( s32 index1, s32 index2 )
     return 0;
 }
 
-void Battle::Board::SetScanPassability( const Unit & unit )
+class Battle::Board::MovePaths
 {
-    std::for_each( begin(), end(), []( Battle::Cell & cell ) { cell.resetReachability(); } );
+public:
+    MovePaths( const Board & board, const Unit & unit );
 
-    at( unit.GetHeadIndex() ).setReachableForHead();
+    // Returns the head cells of the unit for every step to the destination, the current cell is not included.
+    Indexes getPath( const Position & destination ) const;
 
-    if ( unit.isWide() ) {
-        at( unit.GetTailIndex() ).setReachableForTail();
+private:
+    struct Node
+    {
+        uint32_t cost = std::numeric_limits<uint32_t>::max();
+        int32_t from = -1;
+    };
+
+    // The direction of the unit matters only for wide units, a narrow unit always has the right direction.
+    static int32_t getState( const int32_t headCellId, const bool isLeftDirection )
+    {
+        return headCellId * 2 + ( isLeftDirection ? 1 : 0 );
     }
 
-    if ( unit.isFlying() ) {
-        const Bridge * bridge = Arena::GetBridge();
-        const bool isPassableBridge = bridge == nullptr || bridge->isPassable( unit );
+    // States from which the unit is able to continue its movement.
+    std::array<Node, ARENASIZE * 2> _nodes;
+    // States in the moat, the movement can only end there.
+    std::array<Node, ARENASIZE * 2> _finalNodes;
 
-        for ( std::size_t i = 0; i < size(); i++ ) {
-            if ( at( i ).isPassable3( unit, false ) && ( isPassableBridge || !isBridgeIndex( static_cast<int32_t>( i ), unit ) ) ) {
-                at( i ).setReachableForHead();
+    int32_t _startState = -1;
+    bool _isWide = false;
+};
 
-                if ( unit.isWide() ) {
-                    at( i ).setReachableForTail();
-                }
-            }
-        }
-    }
-    else {
-        // Set passable cells.
-        for ( const int32_t idx : GetDistanceIndexes( unit.GetHeadIndex(), unit.GetSpeed() ) ) {
-            GetPath( unit, Position::GetPositionWhenMoved( unit, idx ), false );
-        }
-    }
-}
-
-bool Battle::Board::GetPathForUnit( const Unit & unit, const Position & destination, const uint32_t remainingSteps, const int32_t currentCellId,
-                                    std::vector<bool> & visitedCells, Indexes & result ) const
+Battle::Board::MovePaths::MovePaths( const Board & board, const Unit & unit )
+    : _isWide( unit.isWide() )
 {
-    if ( remainingSteps == 0 ) {
-        return false;
-    }
-
     const Castle * castle = Arena::GetCastle();
     const bool isMoatBuilt = castle && castle->isBuild( BUILD_MOAT );
 
-    const int32_t dstCellId = destination.GetHead()->GetIndex();
-
-    // Upper distance limit
-    if ( GetDistance( currentCellId, dstCellId ) > remainingSteps ) {
-        return false;
-    }
-
-    std::multimap<uint32_t, int32_t> cellCosts;
+    const uint32_t speed = unit.GetSpeed();
 
-    for ( const int32_t cellId : GetAroundIndexes( currentCellId ) ) {
-        const Cell & cell = at( cellId );
+    _startState = getState( unit.GetHeadIndex(), _isWide && unit.isReflect() );
+    _nodes[_startState].cost = 0;
 
-        // Ignore already visited or impassable cell
-        if ( visitedCells.at( cellId ) || !cell.isPassable4( unit, at( currentCellId ) ) ) {
-            continue;
-        }
+    // Turning back is not a movement so the cost of a step is either 0 or 1 and the deque keeps states in the order of their cost.
+    std::deque<int32_t> queue;
+    queue.push_back( _startState );
 
-        // Unit is already at its destination
-        if ( cellId == dstCellId ) {
-            result.push_back( cellId );
+    while ( !queue.empty() ) {
+        const int32_t state = queue.front();
+        queue.pop_front();
 
-            return true;
-        }
+        const uint32_t currentCost = _nodes[state].cost;
 
-        // Unit steps into the moat, do not let it pass through the moat
-        if ( isMoatBuilt && isMoatIndex( cellId, unit ) ) {
-            continue;
-        }
-
-        // Calculate the distance from the cell in question to the destination, sort cells by distance
-        cellCosts.emplace( GetDistance( cellId, dstCellId ), cellId );
-    }
+        const int32_t currentHeadCellId = state / 2;
+        const bool isCurrentLeftDirection = ( state % 2 ) != 0;
+        const int32_t currentTailCellId = isCurrentLeftDirection ? currentHeadCellId + 1 : currentHeadCellId - 1;
 
-    // Scan the available cells recursively in ascending order of distance
-    for ( const auto & cellCost : cellCosts ) {
-        const int32_t cellId = cellCost.second;
+        const Cell & currentCell = board.at( currentHeadCellId );
 
-        // Mark the cell as visited for further steps
-        visitedCells.at( cellId ) = true;
-
-        if ( GetPathForUnit( unit, destination, remainingSteps - 1, cellId, visitedCells, result ) ) {
-            result.push_back( cellId );
-
-            return true;
-        }
-
-        // Unmark the cell as visited
-        visitedCells.at( cellId ) = false;
-    }
-
-    return false;
-}
-
-bool Battle::Board::GetPathForWideUnit( const Unit & unit, const Position & destination, const uint32_t remainingSteps, const int32_t currentHeadCellId,
-                                        const int32_t prevHeadCellId, std::vector<bool> & visitedCells, Indexes & result ) const
-{
-    if ( remainingSteps == 0 ) {
-        return false;
-    }
-
-    const Castle * castle = Arena::GetCastle();
-    const bool isMoatBuilt = castle && castle->isBuild( BUILD_MOAT );
-
-    const int32_t dstHeadCellId = destination.GetHead()->GetIndex();
-    const int32_t dstTailCellId = destination.GetTail()->GetIndex();
-
-    const bool isCurrentLeftDirection = prevHeadCellId < 0 ? unit.isReflect() : ( ( GetDirection( prevHeadCellId, currentHeadCellId ) & LEFT_SIDE ) != 0 );
-    const int32_t currentTailCellId = isCurrentLeftDirection ? currentHeadCellId + 1 : currentHeadCellId - 1;
-
-    // Upper distance limit
-    if ( GetDistance( currentHeadCellId, dstHeadCellId ) > remainingSteps && GetDistance( currentTailCellId, dstHeadCellId ) > remainingSteps ) {
-        return false;
-    }
+        for ( const int32_t headCellId : _isWide ? GetMoveWideIndexes( currentHeadCellId, isCurrentLeftDirection ) : GetAroundIndexes( currentHeadCellId ) ) {
+            if ( !board.at( headCellId ).isPassable4( unit, currentCell ) ) {
+                continue;
+            }
 
-    std::multimap<uint32_t, int32_t> cellCosts;
+            const bool isLeftDirection = _isWide && ( GetDirection( currentHeadCellId, headCellId ) & LEFT_SIDE );
+            const int32_t tailCellId = isLeftDirection ? headCellId + 1 : headCellId - 1;
 
-    for ( const int32_t headCellId : GetMoveWideIndexes( currentHeadCellId, isCurrentLeftDirection ) ) {
-        const Cell & cell = at( headCellId );
+            const bool isTurnBack = _isWide && headCellId == currentTailCellId;
+            const uint32_t cost = isTurnBack ? currentCost : currentCost + 1;
 
-        // Ignore already visited or impassable cell
-        if ( visitedCells.at( headCellId ) || !cell.isPassable4( unit, at( currentHeadCellId ) ) ) {
-            continue;
-        }
+            if ( cost > speed ) {
+                continue;
+            }
 
-        const int32_t tailCellId = ( GetDirection( currentHeadCellId, headCellId ) & LEFT_SIDE ) ? headCellId + 1 : headCellId - 1;
+            // The unit is not allowed to pass through the moat, wide units are only allowed to turn back there.
+            bool isMovementStopped = false;
 
-        // Unit is already at its destination
-        if ( headCellId == dstHeadCellId && tailCellId == dstTailCellId ) {
-            result.push_back( headCellId );
+            if ( isMoatBuilt ) {
+                if ( _isWide ) {
+                    if ( isMoatIndex( headCellId, unit ) || isMoatIndex( tailCellId, unit ) ) {
+                        isMovementStopped = ( tailCellId != currentHeadCellId || !isMoatIndex( tailCellId, unit ) )
+                                            && ( headCellId != currentTailCellId || !isMoatIndex( headCellId, unit ) );
+                    }
+                }
+                else {
+                    isMovementStopped = isMoatIndex( headCellId, unit );
+                }
+            }
 
-            return true;
-        }
+            const int32_t nextState = getState( headCellId, isLeftDirection );
+            Node & node = isMovementStopped ? _finalNodes[nextState] : _nodes[nextState];
 
-        // Unit is already at its destination, but in the opposite direction
-        if ( headCellId == dstTailCellId && tailCellId == dstHeadCellId ) {
-            result.push_back( tailCellId );
-            result.push_back( headCellId );
+            if ( cost >= node.cost ) {
+                continue;
+            }
 
-            return true;
-        }
+            node.cost = cost;
+            node.from = state;
 
-        // Unit steps into the moat
-        if ( isMoatBuilt && ( isMoatIndex( headCellId, unit ) || isMoatIndex( tailCellId, unit ) ) ) {
-            // In the moat it is only allowed to turn back, do not let the unit pass through the moat
-            if ( ( tailCellId != currentHeadCellId || !isMoatIndex( tailCellId, unit ) ) && ( headCellId != currentTailCellId || !isMoatIndex( headCellId, unit ) ) ) {
+            if ( isMovementStopped ) {
                 continue;
             }
-        }
 
-        // Calculate the distance from the cell in question to the destination, sort cells by distance
-        cellCosts.emplace( GetDistance( headCellId, dstHeadCellId ) + GetDistance( tailCellId, dstTailCellId ), headCellId );
+            if ( isTurnBack ) {
+                queue.push_front( nextState );
+            }
+            else {
+                queue.push_back( nextState );
+            }
+        }
     }
+}
 
-    // Scan the available cells recursively in ascending order of distance
-    for ( const auto & cellCost : cellCosts ) {
-        const int32_t headCellId = cellCost.second;
+Battle::Indexes Battle::Board::MovePaths::getPath( const Position & destination ) const
+{
+    Indexes result;
 
-        // Mark the cell as visited for further steps
-        visitedCells.at( headCellId ) = true;
+    const int32_t headCellId = destination.GetHead()->GetIndex();
+    const bool isLeftDirection = _isWide && destination.GetTail()->GetIndex() == headCellId + 1;
 
-        // Turning back is not a movement
-        const uint32_t steps = headCellId == currentTailCellId ? remainingSteps : remainingSteps - 1;
+    const int32_t state = getState( headCellId, isLeftDirection );
+    if ( state == _startState ) {
+        return result;
+    }
 
-        if ( GetPathForWideUnit( unit, destination, steps, headCellId, currentHeadCellId, visitedCells, result ) ) {
-            result.push_back( headCellId );
+    const Node & node = _finalNodes[state].cost < _nodes[state].cost ? _finalNodes[state] : _nodes[state];
+    if ( node.from < 0 ) {
+        return result;
+    }
 
-            return true;
-        }
+    result.push_back( headCellId );
 
-        // Unmark the cell as visited
-        visitedCells.at( headCellId ) = false;
+    for ( int32_t from = node.from; from != _startState; from = _nodes[from].from ) {
+        assert( from >= 0 );
+
+        result.push_back( from / 2 );
     }
 
-    return false;
+    std::reverse( result.begin(), result.end() );
+
+    return result;
 }
 
-void Battle::Board::StraightenPathForUnit( const int32_t currentCellId, Indexes & path ) const
+void Battle::Board::SetScanPassability( const Unit & unit )
 {
-    // A path less than 2 steps long cannot contain detours, leave it as is
-    if ( path.size() < 2 ) {
-        return;
-    }
-
-    // Remember that the steps in the path are stored in reverse order
-    // Temporarily append the current cell of the unit to the end of the path
-    path.push_back( currentCellId );
+    std::for_each( begin(), end(), []( Battle::Cell & cell ) { cell.resetReachability(); } );
 
-    for ( std::size_t curr = 0; path.size() > 2 && curr < path.size() - 2; ++curr ) {
-        const std::size_t next = curr + 1;
+    at( unit.GetHeadIndex() ).setReachableForHead();
 
-        // Check whether we are passing through one of the neighboring cells at any of the future steps (excluding the next step)
-        for ( const int32_t cellId : GetAroundIndexes( path[curr] ) ) {
-            std::size_t pos;
+    if ( unit.isWide() ) {
+        at( unit.GetTailIndex() ).setReachableForTail();
+    }
 
-            // Search for the last occurence of the current neighboring cell in the path (excluding the next step)
-            // Using path.size() - 1 should be safe here, because, due to the condition in the outer loop, path should never be empty
-            assert( !path.empty() );
-            for ( pos = path.size() - 1; pos > next; --pos ) {
-                if ( path[pos] == cellId ) {
-                    break;
-                }
-            }
+    if ( unit.isFlying() ) {
+        const Bridge * bridge = Arena::GetBridge();
+        const bool isPassableBridge = bridge == nullptr || bridge->isPassable( unit );
 
-            // If found, then remove the extra steps
-            if ( pos > next ) {
-                path.erase( path.begin() + next, path.begin() + pos );
+        for ( std::size_t i = 0; i < size(); i++ ) {
+            if ( at( i ).isPassable3( unit, false ) && ( isPassableBridge || !isBridgeIndex( static_cast<int32_t>( i ), unit ) ) ) {
+                at( i ).setReachableForHead();
 
-                break;
+                if ( unit.isWide() ) {
+                    at( i ).setReachableForTail();
+                }
             }
         }
     }
+    else {
+        // Set passable cells, the paths are calculated only once for all of them.
+        const MovePaths paths( *this, unit );
 
-    // Remove the current cell of the unit from the path
-    assert( !path.empty() );
-    path.pop_back();
+        for ( const int32_t idx : GetDistanceIndexes( unit.GetHeadIndex(), unit.GetSpeed() ) ) {
+            GetPath( unit, Position::GetPositionWhenMoved( unit, idx ), paths, false );
+        }
+    }
 }
 
 Battle::Indexes Battle::Board::GetPath( const Unit & unit, const Position & destination, const bool debug ) const
 {
-    Indexes result;
+    return GetPath( unit, destination, MovePaths( *this, unit ), debug );
+}
 
+Battle::Indexes Battle::Board::GetPath( const Unit & unit, const Position & destination, const MovePaths & paths, const bool debug ) const
+{
     const bool isWideUnit = unit.isWide();
 
     // Check if destination is valid
     if ( !destination.GetHead() || ( isWideUnit && !destination.GetTail() ) ) {
         ERROR_LOG( "Invalid destination for unit " + unit.String() );
-        return result;
-    }
-
-    result.reserve( 15 );
-
-    std::vector<bool> visitedCells( ARENASIZE, false );
-
-    // Mark the current cell of the unit as visited
-    visitedCells.at( unit.GetHeadIndex() ) = true;
-
-    if ( isWideUnit ) {
-        GetPathForWideUnit( unit, destination, unit.GetSpeed(), unit.GetHeadIndex(), -1, visitedCells, result );
-    }
-    else {
-        GetPathForUnit( unit, destination, unit.GetSpeed(), unit.GetHeadIndex(), visitedCells, result );
-
-        // Try to straighten the unit's path by eliminating possible detours
-        StraightenPathForUnit( unit.GetHeadIndex(), result );
+        return {};
     }
 
-    if ( !result.empty() ) {
-        std::reverse( result.begin(), result.end() );
+    const Indexes result = paths.getPath( destination );
 
-        // Set direction info for cells
-        for ( std::size_t i = 0; i < result.size(); i++ ) {
-            const int32_t cellId = result[i];
+    // Set direction info for cells
+    for ( std::size_t i = 0; i < result.size(); i++ ) {
+        const int32_t cellId = result[i];
 
-            Cell * headCell = GetCell( cellId );
-            assert( headCell != nullptr );
+        Cell * headCell = GetCell( cellId );
+        assert( headCell != nullptr );
 
-            headCell->setReachableForHead();
+        headCell->setReachableForHead();
 
-            if ( isWideUnit ) {
-                const int32_t prevCellId = i == 0 ? unit.GetHeadIndex() : result[i - 1];
+        if ( isWideUnit ) {
+            const int32_t prevCellId = i == 0 ? unit.GetHeadIndex() : result[i - 1];
 
-                Cell * tailCell = GetCell( cellId, LEFT_SIDE & GetDirection( cellId, prevCellId ) ? LEFT : RIGHT );
-                assert( tailCell != nullptr );
+            Cell * tailCell = GetCell( cellId, LEFT_SIDE & GetDirection( cellId, prevCellId ) ? LEFT : RIGHT );
+            assert( tailCell != nullptr );
 
-                tailCell->setReachableForTail();
-            }
+            tailCell->setReachableForTail();
         }
     }
 
@@ -112,13 +112,12 @@ namespace Battle
         static int32_t FixupDestinationCell( const Unit & currentUnit, const int32_t dst );
 
     private:
+        // Shortest paths of a walking unit to all cells of the board.
+        class MovePaths;
+
         void SetCobjObject( const int icn, const int32_t dst );
 
-        bool GetPathForUnit( const Unit & unit, const Position & destination, const uint32_t remainingSteps, const int32_t currentCellId,
-                             std::vector<bool> & visitedCells, Indexes & result ) const;
-        bool GetPathForWideUnit( const Unit & unit, const Position & destination, const uint32_t remainingSteps, const int32_t currentHeadCellId,
-                                 const int32_t prevHeadCellId, std::vector<bool> & visitedCells, Indexes & result ) const;
-        void StraightenPathForUnit( const int32_t currentCellId, Indexes & path ) const;
+        Indexes GetPath( const Unit & unit, const Position & destination, const MovePaths & paths, const bool debug ) const;
     };
 }
 
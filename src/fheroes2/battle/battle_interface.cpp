@@ -890,6 +890,58 @@ void Battle::ArmiesOrder::Redraw( const Unit * current, fheroes2::Image & output
     }
 }
 
+std::pair<int, int> Battle::getBattlefieldCoverICNs( const int32_t tileIndex )
+{
+    const bool trees = !Maps::ScanAroundObject( tileIndex, MP2::OBJ_TREES ).empty();
+    const int groundType = world.GetTiles( tileIndex ).GetGround();
+
+    int coverIcnId = ICN::UNKNOWN;
+    int frameIcnId = ICN::UNKNOWN;
+
+    switch ( groundType ) {
+    case Maps::Ground::DESERT:
+        coverIcnId = ICN::CBKGDSRT;
+        frameIcnId = ICN::FRNG0004;
+        break;
+    case Maps::Ground::SNOW:
+        coverIcnId = trees ? ICN::CBKGSNTR : ICN::CBKGSNMT;
+        frameIcnId = trees ? ICN::FRNG0006 : ICN::FRNG0007;
+        break;
+    case Maps::Ground::SWAMP:
+        coverIcnId = ICN::CBKGSWMP;
+        frameIcnId = ICN::FRNG0008;
+        break;
+    case Maps::Ground::WASTELAND:
+        coverIcnId = ICN::CBKGCRCK;
+        frameIcnId = ICN::FRNG0003;
+        break;
+    case Maps::Ground::BEACH:
+        coverIcnId = ICN::CBKGBEAC;
+        frameIcnId = ICN::FRNG0002;
+        break;
+    case Maps::Ground::LAVA:
+        coverIcnId = ICN::CBKGLAVA;
+        frameIcnId = ICN::FRNG0005;
+        break;
+    case Maps::Ground::DIRT:
+        coverIcnId = trees ? ICN::CBKGDITR : ICN::CBKGDIMT;
+        frameIcnId = trees ? ICN::FRNG0010 : ICN::FRNG0009;
+        break;
+    case Maps::Ground::GRASS:
+        coverIcnId = trees ? ICN::CBKGGRTR : ICN::CBKGGRMT;
+        frameIcnId = trees ? ICN::FRNG0011 : ICN::FRNG0012;
+        break;
+    case Maps::Ground::WATER:
+        coverIcnId = ICN::CBKGWATR;
+        frameIcnId = ICN::FRNG0013;
+        break;
+    default:
+        break;
+    }
+
+    return std::make_pair( coverIcnId, frameIcnId );
+}
+
 Battle::Interface::Interface( Arena & a, s32 center )
     : arena( a )
     , _surfaceInnerArea( 0, 0, fheroes2::Display::DEFAULT_WIDTH, fheroes2::Display::DEFAULT_HEIGHT )
@@ -923,56 +975,16 @@ Battle::Interface::Interface( Arena & a, s32 center )
     border.SetPosition( _interfacePosition.x - BORDERWIDTH, _interfacePosition.y - BORDERWIDTH, fheroes2::Display::DEFAULT_WIDTH, fheroes2::Display::DEFAULT_HEIGHT );
 
     // cover
-    const bool trees = !Maps::ScanAroundObject( center, MP2::OBJ_TREES ).empty();
-    const Maps::Tiles & tile = world.GetTiles( center );
-
-    const int groundType = tile.GetGround();
+    const int groundType = world.GetTiles( center ).GetGround();
     _brightLandType
         = ( groundType == Maps::Ground::SNOW || groundType == Maps::Ground::DESERT || groundType == Maps::Ground::WASTELAND || groundType == Maps::Ground::BEACH );
     if ( _brightLandType ) {
         _contourColor = 108;
     }
 
-    switch ( groundType ) {
-    case Maps::Ground::DESERT:
-        icn_cbkg = ICN::CBKGDSRT;
-        icn_frng = ICN::FRNG0004;
-        break;
-    case Maps::Ground::SNOW:
-        icn_cbkg = trees ? ICN::CBKGSNTR : ICN::CBKGSNMT;
-        icn_frng = trees ? ICN::FRNG0006 : ICN::FRNG0007;
-        break;
-    case Maps::Ground::SWAMP:
-        icn_cbkg = ICN::CBKGSWMP;
-        icn_frng = ICN::FRNG0008;
-        break;
-    case Maps::Ground::WASTELAND:
-        icn_cbkg = ICN::CBKGCRCK;
-        icn_frng = ICN::FRNG0003;
-        break;
-    case Maps::Ground::BEACH:
-        icn_cbkg = ICN::CBKGBEAC;
-        icn_frng = ICN::FRNG0002;
-        break;
-    case Maps::Ground::LAVA:
-        icn_cbkg = ICN::CBKGLAVA;
-        icn_frng = ICN::FRNG0005;
-        break;
-    case Maps::Ground::DIRT:
-        icn_cbkg = trees ? ICN::CBKGDITR : ICN::CBKGDIMT;
-        icn_frng = trees ? ICN::FRNG0010 : ICN::FRNG0009;
-        break;
-    case Maps::Ground::GRASS:
-        icn_cbkg = trees ? ICN::CBKGGRTR : ICN::CBKGGRMT;
-        icn_frng = trees ? ICN::FRNG0011 : ICN::FRNG0012;
-        break;
-    case Maps::Ground::WATER:
-        icn_cbkg = ICN::CBKGWATR;
-        icn_frng = ICN::FRNG0013;
-        break;
-    default:
-        break;
-    }
+    const std::pair<int, int> coverICNs = getBattlefieldCoverICNs( center );
+    icn_cbkg = coverICNs.first;
+    icn_frng = coverICNs.second;
 
     // hexagon
     sf_hexagon = DrawHexagon( fheroes2::GetColorId( 0x68, 0x8C, 0x04 ) );
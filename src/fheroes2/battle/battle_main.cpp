@@ -203,7 +203,7 @@ Battle::Result Battle::Loader( Army & army1, Army & army2, s32 mapsindex )
     bool showBattle = !Settings::Get().BattleAutoResolve() && isHumanBattle;
 
 #ifdef WITH_DEBUG
-    if ( IS_DEBUG( DBG_BATTLE, DBG_TRACE ) )
+    if ( IS_DEBUG( DBG_BATTLE, DBG_TRACE ) && !Game::isHeadless() )
         showBattle = true;
 #endif
 
@@ -197,14 +197,13 @@ namespace Battle
             }
         }
         else {
-            // Walkers - explore moves sequentially from both head and tail cells
-            std::vector<int32_t> nodesToExplore;
-            nodesToExplore.push_back( pathStart );
+            // Walkers - explore moves in the order of their cost from both head and tail cells
+            startExploration();
+            queueNode( pathStart );
             if ( unitIsWide )
-                nodesToExplore.push_back( unitTail->GetIndex() );
+                queueNode( unitTail->GetIndex() );
 
-            for ( size_t lastProcessedNode = 0; lastProcessedNode < nodesToExplore.size(); ++lastProcessedNode ) {
-                const int32_t fromNode = nodesToExplore[lastProcessedNode];
+            for ( int32_t fromNode = getNextNode(); fromNode != -1; fromNode = getNextNode() ) {
                 const ArenaNode & previousNode = _cache[fromNode];
 
                 Indexes availableMoves;
@@ -251,11 +250,13 @@ namespace Battle
                             node._from = fromNode;
                             node._cost = cost + additionalCost;
                             node._isLeftDirection = isLeftDirection;
-                            nodesToExplore.push_back( newNode );
+                            queueNode( newNode );
                         }
                     }
                 }
             }
+
+            DEBUG_LOG( DBG_BATTLE, DBG_TRACE, "Nodes queued: " << getQueuedNodeCount() << ", explored: " << getExploredNodeCount() );
         }
     }
 }
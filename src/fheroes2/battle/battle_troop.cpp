@@ -105,7 +105,8 @@ u32 Battle::ModesAffected::FindZeroDuration( void ) const
 
 Battle::Unit::Unit( const Troop & t, int32_t pos, bool ref, const Rand::DeterministicRandomGenerator & randomGenerator, const uint32_t uid )
     : ArmyTroop( nullptr, t )
-    , animation( id )
+    // animation data is used only for rendering
+    , animation( Arena::isComputeOnly() ? static_cast<int>( Monster::UNKNOWN ) : id )
     , _uid( uid )
     , hp( t.GetHitPoints() )
     , count0( t.GetCount() )
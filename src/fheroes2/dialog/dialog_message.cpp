@@ -22,13 +22,20 @@
 
 #include "cursor.h"
 #include "dialog.h"
+#include "game.h"
 #include "localevent.h"
+#include "logging.h"
 #include "text.h"
 
 #include "ui_button.h"
 
 int Dialog::Message( const std::string & header, const std::string & message, int ft, int buttons )
 {
+    if ( Game::isHeadless() ) {
+        DEBUG_LOG( DBG_GAME, DBG_INFO, header << ": " << message );
+        return Dialog::ZERO;
+    }
+
     fheroes2::Display & display = fheroes2::Display::instance();
 
     // setup cursor
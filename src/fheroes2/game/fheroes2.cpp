@@ -25,6 +25,7 @@
 #include <string>
 
 #include "agg.h"
+#include "agg_image.h"
 #include "audio.h"
 #include "bin_info.h"
 #include "core.h"
@@ -33,15 +34,14 @@
 #include "game.h"
 #include "game_logo.h"
 #include "game_video.h"
+#include "image_benchmark.h"
 #include "image_palette.h"
 #include "localevent.h"
 #include "logging.h"
 #include "screen.h"
 #include "settings.h"
 #include "system.h"
-#ifdef WITH_DEBUG
 #include "tools.h"
-#endif
 #include "ui_tool.h"
 #include "zzlib.h"
 
@@ -58,6 +58,11 @@ namespace
 #ifdef WITH_DEBUG
         COUT( "  -d <level>\tprint debug messages, see src/engine/logging.h for possible values of <level> argument" );
 #endif
+        COUT( "  -s <file>\trun a headless AI-only simulation of the given map or save file and print timings" );
+        COUT( "  -n <days>\tnumber of days to simulate in headless mode, 28 by default" );
+        COUT( "  -r <seed>\trandom seed for headless mode, 0 by default" );
+        COUT( "  -b <count>\tfight the given number of battles between random armies in headless mode instead of playing days" );
+        COUT( "  -i <count>\tmeasure the given number of iterations of image drawing functions with and without vectorization and exit" );
         COUT( "  -h\t\tprint this help message and exit" );
 
         return EXIT_SUCCESS;
@@ -165,16 +170,47 @@ int main( int argc, char ** argv )
         InitDataDir();
         ReadConfigs();
 
+        std::string simulationFile;
+        uint32_t simulationDays = 28;
+        uint32_t simulationSeed = 0;
+        uint32_t benchmarkBattles = 0;
+        uint32_t benchmarkImageIterations = 0;
+
         // getopt
         {
             int opt;
-            while ( ( opt = System::GetCommandOptions( argc, argv, "hd:" ) ) != -1 )
+            while ( ( opt = System::GetCommandOptions( argc, argv, "hd:s:n:r:b:i:" ) ) != -1 )
                 switch ( opt ) {
 #ifdef WITH_DEBUG
                 case 'd':
                     conf.SetDebug( System::GetOptionsArgument() ? GetInt( System::GetOptionsArgument() ) : 0 );
                     break;
 #endif
+                case 's':
+                    if ( System::GetOptionsArgument() )
+                        simulationFile = System::GetOptionsArgument();
+                    break;
+
+                case 'n':
+                    if ( System::GetOptionsArgument() )
+                        simulationDays = static_cast<uint32_t>( GetInt( System::GetOptionsArgument() ) );
+                    break;
+
+                case 'r':
+                    if ( System::GetOptionsArgument() )
+                        simulationSeed = static_cast<uint32_t>( GetInt( System::GetOptionsArgument() ) );
+                    break;
+
+                case 'b':
+                    if ( System::GetOptionsArgument() )
+                        benchmarkBattles = static_cast<uint32_t>( GetInt( System::GetOptionsArgument() ) );
+                    break;
+
+                case 'i':
+                    if ( System::GetOptionsArgument() )
+                        benchmarkImageIterations = static_cast<uint32_t>( GetInt( System::GetOptionsArgument() ) );
+                    break;
+
                 case '?':
                 case 'h':
                     return PrintHelp( argv[0] );
@@ -184,6 +220,26 @@ int main( int argc, char ** argv )
                 }
         }
 
+        if ( benchmarkImageIterations > 0 ) {
+            return fheroes2::runImageBenchmark( benchmarkImageIterations, simulationSeed ) ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+        if ( !simulationFile.empty() ) {
+            // Headless mode: no display, audio or game controllers, only game data is loaded.
+            const std::set<fheroes2::SystemInitializationComponent> noComponents;
+            const fheroes2::CoreInitializer coreInitializer( noComponents );
+            const AGG::AGGInitializer aggInitializer;
+
+            Bin_Info::InitBinInfo();
+            Game::Init();
+
+            if ( benchmarkBattles > 0 ) {
+                return Game::RunBattleBenchmark( simulationFile, benchmarkBattles, simulationSeed );
+            }
+
+            return Game::RunHeadlessSimulation( simulationFile, simulationDays, simulationSeed );
+        }
+
         std::set<fheroes2::SystemInitializationComponent> coreComponents{ fheroes2::SystemInitializationComponent::Audio,
                                                                           fheroes2::SystemInitializationComponent::Video };
 
@@ -210,6 +266,8 @@ int main( int argc, char ** argv )
         // Load palette.
         fheroes2::setGamePalette( AGG::ReadChunk( "KB.PAL" ) );
 
+        fheroes2::AGG::setImageCacheBudget( static_cast<size_t>( conf.imageCacheSize() ) * 1024 * 1024 );
+
         // load BIN data
         Bin_Info::InitBinInfo();
 
@@ -516,6 +516,10 @@ u32 Game::GetGameOverScores( void )
 
 void Game::ShowMapLoadingText( void )
 {
+    if ( Game::isHeadless() ) {
+        return;
+    }
+
     fheroes2::Display & display = fheroes2::Display::instance();
     const fheroes2::Rect pos( 0, display.height() / 2, display.width(), display.height() / 2 );
     TextBox text( _( "Map is loading..." ), Font::BIG, pos.width );
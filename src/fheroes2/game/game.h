@@ -218,6 +218,13 @@ namespace Game
     void saveDifficulty( const int difficulty );
     void SavePlayers( const std::string & mapFileName, const Players & players );
 
+    // Plays the given map or save file by AI only for the given number of days without display, audio or event processing.
+    // Prints per-day and per-kingdom timings and the final world state hash. Returns the process exit code.
+    int RunHeadlessSimulation( const std::string & fileName, const uint32_t days, const uint32_t seed );
+    // Fights the given number of compute-only battles between random armies on the given map and prints the number of battles per second.
+    int RunBattleBenchmark( const std::string & fileName, const uint32_t battles, const uint32_t seed );
+    bool isHeadless();
+
     std::string GetSaveDir();
     std::string GetSaveFileExtension();
     std::string GetSaveFileExtension( const int gameType );
@@ -172,6 +172,11 @@ int Interface::Basic::GetRedrawMask() const
 
 void Interface::Basic::Redraw( int force )
 {
+    if ( Game::isHeadless() ) {
+        redraw = 0;
+        return;
+    }
+
     const Settings & conf = Settings::Get();
 
     const int combinedRedraw = redraw | force;
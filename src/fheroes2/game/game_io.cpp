@@ -20,7 +20,11 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
+#include <atomic>
+#include <cstdio>
 #include <ctime>
+#include <memory>
+#include <thread>
 
 #include "campaign_savedata.h"
 #include "dialog.h"
@@ -87,11 +91,183 @@ namespace
     {
         return msg >> hdr.status >> hdr.info >> hdr.gameType;
     }
+
+    // Uncompressed part of a save file.
+    void writeHeader( StreamBase & stream, const uint16_t loadver )
+    {
+        const Settings & conf = Settings::Get();
+
+        stream << static_cast<uint8_t>( SAV2ID3 >> 8 ) << static_cast<uint8_t>( SAV2ID3 & 0xFF ) << std::to_string( loadver ) << loadver
+               << HeaderSAV( conf.CurrentFileInfo(), conf.GameType(), CURRENT_FORMAT_VERSION );
+    }
+
+    // Compressed part of a save file.
+    void writeGameData( StreamBase & stream, const uint16_t loadver )
+    {
+        stream << loadver << World::Get() << Settings::Get() << GameOver::Result::Get();
+
+        if ( Settings::Get().isCampaignGameType() )
+            stream << Campaign::CampaignSaveData::Get();
+
+        stream << SAV2ID3; // eof marker
+    }
+
+    bool writeSaveFile( const std::string & fileName, const StreamBuf & header, const StreamBuf & data, const int compressionLevel )
+    {
+        // The file is written under a temporary name first so a failed save does not destroy the previous one.
+        const std::string tempFileName = fileName + ".tmp";
+
+        StreamFile fs;
+        if ( !fs.open( tempFileName, "wb" ) ) {
+            DEBUG_LOG( DBG_GAME, DBG_WARN, tempFileName << ", error open" );
+            return false;
+        }
+
+        fs.putRaw( reinterpret_cast<const char *>( header.data() ), header.size() );
+        fs.close();
+
+        ZStreamChunkWriter fz( compressionLevel, false );
+        bool isWritten = fz.open( tempFileName, true );
+        if ( isWritten ) {
+            fz.putRaw( reinterpret_cast<const char *>( data.data() ), data.size() );
+            isWritten = fz.close();
+        }
+
+        if ( !isWritten ) {
+            DEBUG_LOG( DBG_GAME, DBG_WARN, tempFileName << ", error write" );
+            System::Unlink( tempFileName );
+            return false;
+        }
+
+        // Most systems replace the existing file while renaming, others require to remove it first.
+        if ( std::rename( tempFileName.c_str(), fileName.c_str() ) != 0 ) {
+            System::Unlink( fileName );
+
+            if ( std::rename( tempFileName.c_str(), fileName.c_str() ) != 0 ) {
+                DEBUG_LOG( DBG_GAME, DBG_WARN, fileName << ", error rename" );
+                System::Unlink( tempFileName );
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Autosave serializes the game into memory by the main thread so the game continues right after that.
+    // Compression and writing of the file are done by a separate thread.
+    class AsyncSaveManager
+    {
+    public:
+        AsyncSaveManager() = default;
+        AsyncSaveManager( const AsyncSaveManager & ) = delete;
+
+        ~AsyncSaveManager()
+        {
+            wait();
+        }
+
+        AsyncSaveManager & operator=( const AsyncSaveManager & ) = delete;
+
+        void start( const std::string & fileName, std::unique_ptr<StreamBuf> header, std::unique_ptr<StreamBuf> data, const int compressionLevel )
+        {
+            wait();
+
+            _fileName = fileName;
+            _header = std::move( header );
+            _data = std::move( data );
+            _compressionLevel = compressionLevel;
+
+            _isFinished = false;
+            _worker = std::thread( workerThread, this );
+        }
+
+        void wait()
+        {
+            if ( _worker.joinable() ) {
+                _worker.join();
+                onFinish();
+            }
+        }
+
+        bool getResult( bool & isSaved )
+        {
+            if ( _worker.joinable() && _isFinished ) {
+                _worker.join();
+                onFinish();
+            }
+
+            if ( !_isResultPending ) {
+                return false;
+            }
+
+            _isResultPending = false;
+            isSaved = _isSaved;
+            return true;
+        }
+
+        // Size of the previous snapshot is used to allocate memory for the next one at once.
+        size_t lastSnapshotSize() const
+        {
+            return _lastSnapshotSize;
+        }
+
+    private:
+        std::thread _worker;
+        std::atomic<bool> _isFinished{ false };
+
+        std::string _fileName;
+        std::unique_ptr<StreamBuf> _header;
+        std::unique_ptr<StreamBuf> _data;
+        int _compressionLevel = 0;
+
+        bool _isSaved = false;
+        bool _isResultPending = false;
+        size_t _lastSnapshotSize = 0;
+
+        void onFinish()
+        {
+            _lastSnapshotSize = _data->size();
+            _header.reset();
+            _data.reset();
+            _isResultPending = true;
+        }
+
+        static void workerThread( AsyncSaveManager * manager )
+        {
+            manager->_isSaved = writeSaveFile( manager->_fileName, *manager->_header, *manager->_data, manager->_compressionLevel );
+            manager->_isFinished = true;
+        }
+    };
+
+    AsyncSaveManager asyncSaveManager;
 }
 
 bool Game::AutoSave()
 {
-    return Game::Save( System::ConcatePath( GetSaveDir(), "AUTOSAVE" + GetSaveFileExtension() ) );
+    const std::string fileName = System::ConcatePath( GetSaveDir(), "AUTOSAVE" + GetSaveFileExtension() );
+    DEBUG_LOG( DBG_GAME, DBG_INFO, fileName );
+
+    const uint16_t loadver = GetLoadVersion();
+
+    std::unique_ptr<StreamBuf> header( new StreamBuf() );
+    header->setbigendian( true );
+    writeHeader( *header, loadver );
+
+    std::unique_ptr<StreamBuf> data( new StreamBuf( asyncSaveManager.lastSnapshotSize() ) );
+    data->setbigendian( true );
+    writeGameData( *data, loadver );
+
+    if ( header->fail() || data->fail() ) {
+        return false;
+    }
+
+    asyncSaveManager.start( fileName, std::move( header ), std::move( data ), Settings::Get().saveCompressionLevel() );
+    return true;
+}
+
+bool Game::getAutoSaveResult( bool & isSaved )
+{
+    return asyncSaveManager.getResult( isSaved );
 }
 
 bool Game::Save( const std::string & fn )
@@ -100,6 +276,8 @@ bool Game::Save( const std::string & fn )
     const bool autosave = ( System::GetBasename( fn ) == "AUTOSAVE" + GetSaveFileExtension() );
     const Settings & conf = Settings::Get();
 
+    asyncSaveManager.wait();
+
     StreamFile fs;
     fs.setbigendian( true );
 
@@ -113,28 +291,31 @@ bool Game::Save( const std::string & fn )
         Game::SetLastSavename( fn );
 
     // raw info content
-    fs << static_cast<uint8_t>( SAV2ID3 >> 8 ) << static_cast<uint8_t>( SAV2ID3 & 0xFF ) << std::to_string( loadver ) << loadver
-       << HeaderSAV( conf.CurrentFileInfo(), conf.GameType(), CURRENT_FORMAT_VERSION );
+    writeHeader( fs, loadver );
     fs.close();
 
-    ZStreamFile fz;
+    // Game data is compressed by chunks while it is being serialized, by a separate thread if possible.
+    ZStreamChunkWriter fz( conf.saveCompressionLevel(), std::thread::hardware_concurrency() > 1 );
     fz.setbigendian( true );
 
-    // zip game data content
-    fz << loadver << World::Get() << Settings::Get() << GameOver::Result::Get();
-
-    if ( conf.isCampaignGameType() )
-        fz << Campaign::CampaignSaveData::Get();
+    if ( !fz.open( fn, true ) ) {
+        DEBUG_LOG( DBG_GAME, DBG_WARN, fn << ", error open" );
+        return false;
+    }
 
-    fz << SAV2ID3; // eof marker
+    // zip game data content
+    writeGameData( fz, loadver );
 
-    return !fz.fail() && fz.write( fn, true );
+    return fz.close() && !fz.fail();
 }
 
 fheroes2::GameMode Game::Load( const std::string & fn )
 {
     DEBUG_LOG( DBG_GAME, DBG_INFO, fn );
 
+    // The file might be the autosave which is still being written.
+    asyncSaveManager.wait();
+
     StreamFile fs;
     fs.setbigendian( true );
 
@@ -180,10 +361,10 @@ fheroes2::GameMode Game::Load( const std::string & fn )
         return fheroes2::GameMode::CANCEL;
     }
 
-    ZStreamFile fz;
+    ZStreamChunkReader fz;
     fz.setbigendian( true );
 
-    if ( !fz.read( fn, offset ) ) {
+    if ( !fz.open( fn, offset ) ) {
         DEBUG_LOG( DBG_GAME, DBG_WARN, ", uncompress: error" );
         return fheroes2::GameMode::CANCEL;
     }
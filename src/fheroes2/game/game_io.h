@@ -34,8 +34,12 @@ namespace Maps
 
 namespace Game
 {
+    // Takes a snapshot of the game and writes it to the autosave file by a separate thread.
     bool AutoSave();
 
+    // Returns true once after the autosave started by AutoSave() is finished. isSaved is set to false if the file was not written.
+    bool getAutoSaveResult( bool & isSaved );
+
     bool Save( const std::string & );
 
     // Returns GameMode::CANCEL in case of failure.
@@ -68,6 +68,9 @@ void Game::mainGameLoop( bool isFirstGameRun )
     fheroes2::GameMode result = fheroes2::GameMode::MAIN_MENU;
 
     while ( result != fheroes2::GameMode::QUIT_GAME ) {
+        // Nothing holds images between game modes so it is a right moment to release those of them which do not fit into the memory budget.
+        fheroes2::AGG::releaseUnusedImages();
+
         switch ( result ) {
         case fheroes2::GameMode::MAIN_MENU:
             result = Game::MainMenu( isFirstGameRun );
@@ -0,0 +1,325 @@
+/***************************************************************************
+ *   Free Heroes of Might and Magic II: https://github.com/ihhub/fheroes2  *
+ *   Copyright (C) 2021                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "ai.h"
+#include "army.h"
+#include "battle.h"
+#include "color.h"
+#include "game.h"
+#include "game_io.h"
+#include "game_over.h"
+#include "kingdom.h"
+#include "logging.h"
+#include "maps_fileinfo.h"
+#include "maps_tiles.h"
+#include "monster.h"
+#include "rand.h"
+#include "serialize.h"
+#include "settings.h"
+#include "tools.h"
+#include "world.h"
+
+namespace
+{
+    bool headlessMode = false;
+
+    using Clock = std::chrono::steady_clock;
+
+    std::string timeToString( const Clock::duration duration )
+    {
+        std::ostringstream os;
+        os << std::fixed << std::setprecision( 3 ) << std::chrono::duration<double, std::milli>( duration ).count() << " ms";
+        return os.str();
+    }
+
+    // FNV-1a hash of the serialized world, it changes on any difference in the game state
+    std::string getWorldStateHash()
+    {
+        StreamBuf buffer( 1024 * 1024 );
+        buffer.setbigendian( true );
+        buffer << World::Get();
+
+        uint64_t hash = 14695981039346656037ULL;
+        const uint8_t * data = buffer.data();
+
+        for ( size_t i = 0; i < buffer.size(); ++i ) {
+            hash ^= data[i];
+            hash *= 1099511628211ULL;
+        }
+
+        std::ostringstream os;
+        os << std::hex << std::setw( 16 ) << std::setfill( '0' ) << hash;
+        return os.str();
+    }
+
+    bool loadSimulationGame( const std::string & fileName )
+    {
+        Settings & conf = Settings::Get();
+
+        const std::string extension = fileName.size() > 3 ? StringLower( fileName.substr( fileName.size() - 3 ) ) : std::string();
+
+        if ( extension == "mp2" || extension == "mx2" ) {
+            Maps::FileInfo fileInfo;
+            if ( !fileInfo.ReadMP2( fileName ) ) {
+                ERROR_LOG( "Failed to read map file " << fileName );
+                return false;
+            }
+
+            conf.SetGameType( Game::TYPE_STANDARD );
+            conf.SetCurrentFileInfo( fileInfo );
+            conf.GetPlayers().SetAllControlAI();
+            conf.GetPlayers().SetStartGame();
+
+            return world.LoadMapMP2( fileInfo.file );
+        }
+
+        // Any type of save file is accepted, the game type is taken from the file itself.
+        conf.SetGameType( Game::TYPE_STANDARD | Game::TYPE_CAMPAIGN | Game::TYPE_HOTSEAT );
+
+        if ( Game::Load( fileName ) != fheroes2::GameMode::START_GAME ) {
+            ERROR_LOG( "Failed to load save file " << fileName );
+            return false;
+        }
+
+        conf.GetPlayers().SetAllControlAI();
+
+        return true;
+    }
+
+    // Fills the army with up to 5 random troops of the given total strength.
+    void generateArmy( Army & army, const double strength )
+    {
+        const uint32_t troopCount = Rand::Get( 1, 5 );
+
+        for ( uint32_t i = 0; i < troopCount; ++i ) {
+            const Monster monster = Monster::Rand( Monster::LevelType::LEVEL_ANY );
+            const uint32_t count = std::max( 1u, static_cast<uint32_t>( strength / troopCount / monster.GetMonsterStrength() ) );
+
+            army.JoinTroop( monster, count );
+        }
+    }
+
+    int countActiveKingdoms( const std::vector<Player *> & players )
+    {
+        return static_cast<int>( std::count_if( players.begin(), players.end(), []( const Player * player ) { return world.GetKingdom( player->GetColor() ).isPlay(); } ) );
+    }
+}
+
+bool Game::isHeadless()
+{
+    return headlessMode;
+}
+
+int Game::RunHeadlessSimulation( const std::string & fileName, const uint32_t days, const uint32_t seed )
+{
+    headlessMode = true;
+
+    // All random decisions made on the main thread come from this generator so the same seed always gives the same game.
+    Rand::CurrentThreadRandomDevice().seed( seed );
+
+    if ( !loadSimulationGame( fileName ) ) {
+        return EXIT_FAILURE;
+    }
+
+    Settings & conf = Settings::Get();
+
+    std::vector<Player *> players = conf.GetPlayers();
+    std::sort( players.begin(), players.end(), []( const Player * player1, const Player * player2 ) { return player1->GetColor() < player2->GetColor(); } );
+
+    COUT( "Simulation of " << fileName << " for " << days << " days, seed " << seed << ", players: " << conf.GetPlayers().String() );
+
+    // Total turn time and the number of turns per kingdom color.
+    std::map<int, std::pair<Clock::duration, uint32_t>> kingdomTurnTime;
+    Clock::duration totalTime{ 0 };
+
+    bool loadedFromSave = conf.LoadedGameVersion();
+    bool skipTurns = loadedFromSave;
+    int winnerColor = Color::NONE;
+    uint32_t simulatedDays = 0;
+
+    while ( simulatedDays < days && winnerColor == Color::NONE && countActiveKingdoms( players ) > 1 ) {
+        const Clock::time_point dayStart = Clock::now();
+
+        std::ostringstream dayReport;
+
+        if ( !loadedFromSave ) {
+            world.NewDay();
+
+            const World::NewDayTimings & timings = world.getNewDayTimings();
+            const auto secondsToDuration = []( const double seconds ) {
+                return std::chrono::duration_cast<Clock::duration>( std::chrono::duration<double>( seconds ) );
+            };
+
+            dayReport << ", new day (map objects: " << timeToString( secondsToDuration( timings.mapObjects ) )
+                      << ", kingdoms: " << timeToString( secondsToDuration( timings.kingdoms ) ) << ", castles: " << timeToString( secondsToDuration( timings.castles ) )
+                      << ", heroes: " << timeToString( secondsToDuration( timings.heroes ) ) << ")";
+        }
+
+        for ( const Player * player : players ) {
+            const int color = player->GetColor();
+
+            if ( skipTurns && color != conf.CurrentColor() ) {
+                continue;
+            }
+
+            skipTurns = false;
+            loadedFromSave = false;
+
+            Kingdom & kingdom = world.GetKingdom( color );
+            if ( !kingdom.isPlay() ) {
+                continue;
+            }
+
+            const Clock::time_point turnStart = Clock::now();
+
+            conf.SetCurrentColor( color );
+
+            world.ClearFog( color );
+            kingdom.ActionBeforeTurn();
+
+            AI::Get().KingdomTurn( kingdom );
+
+            const Clock::duration turnTime = Clock::now() - turnStart;
+            std::pair<Clock::duration, uint32_t> & kingdomTime = kingdomTurnTime[color];
+            kingdomTime.first += turnTime;
+            ++kingdomTime.second;
+
+            dayReport << ", " << Color::String( color ) << ": " << timeToString( turnTime );
+
+            if ( world.CheckKingdomWins( kingdom ) != GameOver::COND_NONE ) {
+                winnerColor = color;
+                break;
+            }
+        }
+
+        if ( skipTurns ) {
+            ERROR_LOG( "The current player from the save file was not found, player color: " << Color::String( conf.CurrentColor() ) );
+            return EXIT_FAILURE;
+        }
+
+        conf.SetCurrentColor( -1 );
+
+        const Clock::duration dayTime = Clock::now() - dayStart;
+        totalTime += dayTime;
+        ++simulatedDays;
+
+        COUT( world.DateString() << ": " << timeToString( dayTime ) << dayReport.str() );
+    }
+
+    COUT( "Simulated days: " << simulatedDays << ", total time: " << timeToString( totalTime ) << ", average day time: "
+                             << timeToString( simulatedDays > 0 ? totalTime / simulatedDays : totalTime ) );
+
+    for ( const auto & turnTime : kingdomTurnTime ) {
+        const Clock::duration & kingdomTime = turnTime.second.first;
+        const uint32_t turns = turnTime.second.second;
+
+        COUT( "Kingdom " << Color::String( turnTime.first ) << ", turns: " << turns << ", total turn time: " << timeToString( kingdomTime )
+                         << ", average turn time: " << timeToString( kingdomTime / turns ) );
+    }
+
+    if ( winnerColor != Color::NONE ) {
+        COUT( "Winner: " << Color::String( winnerColor ) );
+    }
+
+    COUT( "World state hash: " << getWorldStateHash() );
+
+    headlessMode = false;
+
+    return EXIT_SUCCESS;
+}
+
+int Game::RunBattleBenchmark( const std::string & fileName, const uint32_t battles, const uint32_t seed )
+{
+    headlessMode = true;
+
+    Rand::CurrentThreadRandomDevice().seed( seed );
+
+    if ( !loadSimulationGame( fileName ) ) {
+        return EXIT_FAILURE;
+    }
+
+    const Players & players = Settings::Get().GetPlayers();
+    if ( players.empty() ) {
+        ERROR_LOG( "No players on map " << fileName );
+        return EXIT_FAILURE;
+    }
+
+    // battles take place on land tiles outside of towns, the battlefield obstacles depend on the tile
+    std::vector<int32_t> battleTiles;
+
+    for ( int32_t index = 0; index < world.w() * world.h(); ++index ) {
+        if ( !world.GetTiles( index ).isWater() && world.getCastleEntrance( Maps::GetPoint( index ) ) == nullptr ) {
+            battleTiles.push_back( index );
+        }
+    }
+
+    if ( battleTiles.empty() ) {
+        ERROR_LOG( "No land tiles on map " << fileName );
+        return EXIT_FAILURE;
+    }
+
+    // The first player attacks neutral armies which are stronger or weaker up to 2 times.
+    const int attackerColor = players.front()->GetColor();
+
+    uint32_t attackerWins = 0;
+    uint32_t totalKilled = 0;
+    Clock::duration totalTime{ 0 };
+
+    for ( uint32_t i = 0; i < battles; ++i ) {
+        const double strength = 1000.0 * Rand::Get( 1, 20 );
+
+        Army attacker;
+        attacker.SetColor( attackerColor );
+        generateArmy( attacker, strength );
+
+        Army defender;
+        generateArmy( defender, strength * Rand::Get( 50, 200 ) / 100 );
+
+        const int32_t tileIndex = Rand::Get( battleTiles );
+
+        const Clock::time_point battleStart = Clock::now();
+        const Battle::Result result = Battle::Loader( attacker, defender, tileIndex );
+        totalTime += Clock::now() - battleStart;
+
+        if ( result.army1 & Battle::RESULT_WINS ) {
+            ++attackerWins;
+        }
+        totalKilled += result.killed;
+    }
+
+    const double seconds = std::chrono::duration<double>( totalTime ).count();
+
+    COUT( "Battles: " << battles << ", total time: " << timeToString( totalTime ) << ", battles per second: " << ( seconds > 0 ? battles / seconds : 0.0 ) );
+    COUT( "Attacker wins: " << attackerWins << ", killed units of the losers: " << totalKilled );
+
+    headlessMode = false;
+
+    return EXIT_SUCCESS;
+}
@@ -773,6 +773,15 @@ fheroes2::GameMode Interface::Basic::HumanTurn( bool isload )
 
     // startgame loop
     while ( fheroes2::GameMode::CANCEL == res ) {
+        // All windows opened from the adventure map are closed at this point so images which are not in use can be released.
+        fheroes2::AGG::releaseUnusedImages();
+
+        bool isAutoSaved = false;
+        if ( Game::getAutoSaveResult( isAutoSaved ) ) {
+            statusWindow.SetMessage( isAutoSaved ? _( "The game has been autosaved." ) : _( "Autosave has failed!" ) );
+            statusWindow.SetRedraw();
+        }
+
         if ( !le.HandleEvents( Game::isDelayNeeded( delayTypes ), true ) ) {
             if ( EventExit() == fheroes2::GameMode::QUIT_GAME ) {
                 res = fheroes2::GameMode::QUIT_GAME;
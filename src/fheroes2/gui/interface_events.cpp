@@ -24,7 +24,10 @@
 #include <vector>
 
 #include "agg.h"
+#include "agg_image.h"
 #include "audio.h"
+#include "battle.h"
+#include "castle.h"
 #include "cursor.h"
 #include "dialog_system_options.h"
 #include "game.h"
@@ -32,9 +35,14 @@
 #include "game_io.h"
 #include "game_over.h"
 #include "heroes.h"
+#include "icn.h"
 #include "kingdom.h"
 #include "logging.h"
 #include "m82.h"
+#include "maps.h"
+#include "monster_info.h"
+#include "players.h"
+#include "race.h"
 #include "settings.h"
 #include "system.h"
 #include "text.h"
@@ -42,6 +50,108 @@
 #include "translations.h"
 #include "world.h"
 
+namespace
+{
+    void prefetchArmyICNs( const Army & army )
+    {
+        for ( size_t i = 0; i < army.Size(); ++i ) {
+            const Troop * troop = army.GetTroop( i );
+            if ( troop != nullptr && troop->isValid() ) {
+                fheroes2::AGG::prefetchICN( fheroes2::getMonsterData( troop->GetID() ).icnId );
+            }
+        }
+    }
+
+    void prefetchBattleICNs( const Heroes & hero, const int32_t tileIndex )
+    {
+        const std::pair<int, int> coverICNs = Battle::getBattlefieldCoverICNs( tileIndex );
+        fheroes2::AGG::prefetchICN( coverICNs.first );
+        fheroes2::AGG::prefetchICN( coverICNs.second );
+
+        prefetchArmyICNs( hero.GetArmy() );
+    }
+
+    int getTownBackgroundICN( const int race )
+    {
+        switch ( race ) {
+        case Race::KNGT:
+            return ICN::TOWNBKG0;
+        case Race::BARB:
+            return ICN::TOWNBKG1;
+        case Race::SORC:
+            return ICN::TOWNBKG2;
+        case Race::WRLK:
+            return ICN::TOWNBKG3;
+        case Race::WZRD:
+            return ICN::TOWNBKG4;
+        case Race::NECR:
+            return ICN::TOWNBKG5;
+        default:
+            break;
+        }
+
+        return ICN::UNKNOWN;
+    }
+
+    // Starts loading in background the images of a battle or a town screen which will be shown when the hero reaches the destination.
+    void prefetchDestinationICNs( const Heroes & hero, const int32_t destinationIdx )
+    {
+        const Maps::Tiles & tile = world.GetTiles( destinationIdx );
+
+        switch ( tile.GetObject() ) {
+        case MP2::OBJ_MONSTER:
+            prefetchBattleICNs( hero, destinationIdx );
+            fheroes2::AGG::prefetchICN( fheroes2::getMonsterData( tile.QuantityMonster().GetID() ).icnId );
+            break;
+
+        case MP2::OBJ_HEROES: {
+            const Heroes * otherHero = tile.GetHeroes();
+            if ( otherHero != nullptr && !Players::isFriends( hero.GetColor(), otherHero->GetColor() ) ) {
+                prefetchBattleICNs( hero, destinationIdx );
+                prefetchArmyICNs( otherHero->GetArmy() );
+            }
+            break;
+        }
+
+        case MP2::OBJ_CASTLE: {
+            const Castle * castle = world.getCastleEntrance( Maps::GetPoint( destinationIdx ) );
+            if ( castle == nullptr ) {
+                break;
+            }
+
+            const int race = castle->GetRace();
+
+            if ( castle->GetColor() == hero.GetColor() ) {
+                const int backgroundIcnId = getTownBackgroundICN( race );
+                if ( backgroundIcnId != ICN::UNKNOWN ) {
+                    fheroes2::AGG::prefetchICN( backgroundIcnId );
+                }
+
+                for ( uint32_t building = 1; building != 0; building <<= 1 ) {
+                    if ( castle->isBuild( building ) ) {
+                        const int buildingIcnId = Castle::GetICNBuilding( building, race );
+                        if ( buildingIcnId != ICN::UNKNOWN ) {
+                            fheroes2::AGG::prefetchICN( buildingIcnId );
+                        }
+                    }
+                }
+
+                fheroes2::AGG::prefetchICN( ICN::Get4Building( race ) );
+            }
+            else if ( !Players::isFriends( hero.GetColor(), castle->GetColor() ) ) {
+                prefetchBattleICNs( hero, destinationIdx );
+                prefetchArmyICNs( castle->GetArmy() );
+                fheroes2::AGG::prefetchICN( ICN::Get4Castle( race ) );
+            }
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+}
+
 void Interface::Basic::CalculateHeroPath( Heroes * hero, s32 destinationIdx ) const
 {
     if ( ( hero == nullptr ) || hero->Modes( Heroes::GUARDIAN ) )
@@ -58,6 +168,10 @@ void Interface::Basic::CalculateHeroPath( Heroes * hero, s32 destinationIdx ) co
         DEBUG_LOG( DBG_GAME, DBG_TRACE, hero->GetName() << ", distance: " << world.getDistance( *hero, destinationIdx ) << ", route: " << path.String() );
         gameArea.SetRedraw();
 
+        if ( path.isValid() ) {
+            prefetchDestinationICNs( *hero, destinationIdx );
+        }
+
         const fheroes2::Point & mousePos = LocalEvent::Get().GetMouseCursor();
         if ( gameArea.GetROI() & mousePos ) {
             const int32_t cursorIndex = gameArea.GetValidTileIdFromPoint( mousePos );
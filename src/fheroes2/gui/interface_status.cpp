@@ -25,6 +25,7 @@
 #include "agg_image.h"
 #include "army.h"
 #include "castle.h"
+#include "game.h"
 #include "game_interface.h"
 #include "heroes.h"
 #include "icn.h"
@@ -65,7 +66,7 @@ u32 Interface::StatusWindow::ResetResourceStatus( u32 /*tick*/, void * ptr )
 {
     if ( ptr ) {
         Interface::StatusWindow * status = static_cast<Interface::StatusWindow *>( ptr );
-        if ( StatusType::STATUS_RESOURCE == status->_state ) {
+        if ( StatusType::STATUS_RESOURCE == status->_state || StatusType::STATUS_MESSAGE == status->_state ) {
             status->_state = status->_oldState;
             Interface::Basic::Get().SetRedraw( REDRAW_STATUS );
         }
@@ -101,7 +102,7 @@ void Interface::StatusWindow::SetPos( s32 ox, s32 oy )
 
 void Interface::StatusWindow::SetState( const StatusType status )
 {
-    if ( StatusType::STATUS_RESOURCE != _state )
+    if ( StatusType::STATUS_RESOURCE != _state && StatusType::STATUS_MESSAGE != _state )
         _state = status;
 }
 
@@ -132,10 +133,12 @@ void Interface::StatusWindow::Redraw( void ) const
             if ( conf.CurrentColor() & Players::HumanColors() ) {
                 DrawKingdomInfo( stonHeight + 5 );
 
-                if ( _state != StatusType::STATUS_RESOURCE )
-                    DrawArmyInfo( 2 * stonHeight + 10 );
-                else
+                if ( _state == StatusType::STATUS_RESOURCE )
                     DrawResourceInfo( 2 * stonHeight + 10 );
+                else if ( _state == StatusType::STATUS_MESSAGE )
+                    DrawMessage( 2 * stonHeight + 10 );
+                else
+                    DrawArmyInfo( 2 * stonHeight + 10 );
             }
         }
         else if ( StatusType::STATUS_UNKNOWN != _state && pos.height >= ( stonHeight * 2 + 15 ) ) {
@@ -152,6 +155,9 @@ void Interface::StatusWindow::Redraw( void ) const
             case StatusType::STATUS_RESOURCE:
                 DrawResourceInfo( stonHeight + 5 );
                 break;
+            case StatusType::STATUS_MESSAGE:
+                DrawMessage( stonHeight + 5 );
+                break;
             case StatusType::STATUS_UNKNOWN:
             case StatusType::STATUS_AITURN:
                 assert( 0 ); // we shouldn't even reach this code
@@ -174,6 +180,9 @@ void Interface::StatusWindow::Redraw( void ) const
             case StatusType::STATUS_RESOURCE:
                 DrawResourceInfo();
                 break;
+            case StatusType::STATUS_MESSAGE:
+                DrawMessage();
+                break;
             case StatusType::STATUS_UNKNOWN:
             case StatusType::STATUS_AITURN:
                 assert( 0 ); // we shouldn't even reach this code
@@ -205,7 +214,7 @@ void Interface::StatusWindow::NextState( void )
             _state = StatusType::STATUS_DAY;
         }
     }
-    else if ( StatusType::STATUS_RESOURCE == _state )
+    else if ( StatusType::STATUS_RESOURCE == _state || StatusType::STATUS_MESSAGE == _state )
         _state = StatusType::STATUS_ARMY;
 
     if ( _state == StatusType::STATUS_ARMY ) {
@@ -295,6 +304,19 @@ void Interface::StatusWindow::SetResource( int res, u32 count )
     timerShowLastResource.run( resourceWindowExpireTime, ResetResourceStatus, this );
 }
 
+void Interface::StatusWindow::SetMessage( const std::string & message )
+{
+    _message = message;
+
+    if ( timerShowLastResource.valid() )
+        timerShowLastResource.remove();
+    else
+        _oldState = _state;
+
+    _state = StatusType::STATUS_MESSAGE;
+    timerShowLastResource.run( resourceWindowExpireTime, ResetResourceStatus, this );
+}
+
 void Interface::StatusWindow::ResetTimer( void )
 {
     StatusWindow & window = Interface::Basic::Get().GetStatusWindow();
@@ -321,6 +343,14 @@ void Interface::StatusWindow::DrawResourceInfo( int oh ) const
     text.Blit( pos.x + ( pos.width - text.w() ) / 2, pos.y + oh + text.h() * 2 + spr.height() + 8 );
 }
 
+void Interface::StatusWindow::DrawMessage( int oh ) const
+{
+    const fheroes2::Rect & pos = GetArea();
+
+    TextBox text( _message, Font::SMALL, pos.width );
+    text.Blit( pos.x, pos.y + 4 + oh );
+}
+
 void Interface::StatusWindow::DrawArmyInfo( int oh ) const
 {
     const Army * armies = nullptr;
@@ -460,6 +490,11 @@ void Interface::StatusWindow::QueueEventProcessing( void )
 void Interface::StatusWindow::RedrawTurnProgress( u32 v )
 {
     turn_progress = v;
+
+    if ( Game::isHeadless() ) {
+        return;
+    }
+
     SetRedraw();
 
     interface.Redraw();
@@ -23,6 +23,8 @@
 #ifndef H2INTERFACE_STATUS_H
 #define H2INTERFACE_STATUS_H
 
+#include <string>
+
 #include "interface_border.h"
 #include "timing.h"
 
@@ -37,6 +39,7 @@ namespace Interface
         STATUS_FUNDS,
         STATUS_ARMY,
         STATUS_RESOURCE,
+        STATUS_MESSAGE,
         STATUS_AITURN
     };
 
@@ -56,6 +59,8 @@ namespace Interface
 
         void SetState( const StatusType status );
         void SetResource( int, u32 );
+        // Shows a short message for a few seconds the same way as a found resource.
+        void SetMessage( const std::string & message );
         void RedrawTurnProgress( u32 );
         void QueueEventProcessing();
 
@@ -66,6 +71,7 @@ namespace Interface
         void DrawDayInfo( int oh = 0 ) const;
         void DrawArmyInfo( int oh = 0 ) const;
         void DrawResourceInfo( int oh = 0 ) const;
+        void DrawMessage( int oh = 0 ) const;
         void DrawBackground() const;
         void DrawAITurns() const;
         static u32 ResetResourceStatus( u32, void * );
@@ -77,6 +83,7 @@ namespace Interface
         int lastResource;
         uint32_t countLastResource;
         uint32_t turn_progress;
+        std::string _message;
 
         fheroes2::Timer timerShowLastResource;
     };
@@ -19,6 +19,7 @@
  ***************************************************************************/
 
 #include "ui_tool.h"
+#include "agg_image.h"
 #include "localevent.h"
 #include "screen.h"
 #include "settings.h"
@@ -81,6 +82,23 @@ namespace
                 info += std::to_string( static_cast<int>( ( averageFps - currentFps ) * 10 ) );
             }
 
+            // Time of conversion and upload of the previous frame to the screen.
+            const uint32_t renderTime = fheroes2::Display::instance().lastRenderTime();
+            info += _( ", frame: " );
+            info += std::to_string( renderTime / 1000 );
+            info += '.';
+            info += std::to_string( renderTime % 1000 / 100 );
+            info += " ms";
+
+            const fheroes2::AGG::ImageCacheStatistics & imageStatistics = fheroes2::AGG::getImageCacheStatistics();
+            info += _( ", images: " );
+            info += std::to_string( imageStatistics.bytesResident / ( 1024 * 1024 ) );
+            info += " MB, ";
+            info += std::to_string( imageStatistics.misses );
+            info += _( " loads, " );
+            info += std::to_string( imageStatistics.evictions );
+            info += _( " releases" );
+
             _text.SetPos( offsetX, offsetY );
             _text.SetText( info );
             _text.Show();
@@ -2182,8 +2182,12 @@ void ActionToCaptureObject( Heroes & hero, const MP2::MapObjectType objectType,
         // check if it is already guarded by a spell
         const bool readonly = tile.GetQuantity3() != 0;
 
-        if ( Dialog::SetGuardian( hero, troop2, co, readonly ) )
+        if ( Dialog::SetGuardian( hero, troop2, co, readonly ) ) {
             troop1.Set( troop2.GetMonster(), troop2.GetCount() );
+
+            // Guardians affect AI pathfinding
+            world.invalidatePathfinderTile( dst_index );
+        }
     }
 
     if ( objectType == MP2::OBJ_LIGHTHOUSE )
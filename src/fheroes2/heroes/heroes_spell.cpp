@@ -655,6 +655,9 @@ bool ActionSpellSetGuardian( Heroes & hero, const Spell & spell )
         }
 
         world.GetCapturedObject( tile.GetIndex() ).GetTroop().Set( Monster( spell ), count );
+
+        // Guardians affect AI pathfinding
+        world.invalidatePathfinderTile( tile.GetIndex() );
         return true;
     }
 
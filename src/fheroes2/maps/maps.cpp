@@ -87,13 +87,39 @@ namespace
 
     Maps::Indexes MapsIndexesObject( const MP2::MapObjectType objectType, const bool ignoreHeroes = true )
     {
+        const MapObjectIndex & objectIndex = world.getObjectIndex();
+        if ( !objectIndex.isBuilt() ) {
+            Maps::Indexes result;
+            const int32_t size = static_cast<int32_t>( world.getSize() );
+            for ( int32_t idx = 0; idx < size; ++idx ) {
+                if ( world.GetTiles( idx ).GetObject( !ignoreHeroes ) == objectType ) {
+                    result.push_back( idx );
+                }
+            }
+            return result;
+        }
+
+        const std::set<int32_t> & objects = objectIndex.getObjects( objectType );
+
         Maps::Indexes result;
-        const int32_t size = static_cast<int32_t>( world.getSize() );
-        for ( int32_t idx = 0; idx < size; ++idx ) {
-            if ( world.GetTiles( idx ).GetObject( !ignoreHeroes ) == objectType ) {
+        if ( !ignoreHeroes ) {
+            result.assign( objects.begin(), objects.end() );
+            return result;
+        }
+
+        // Heroes hide objects under them in the index
+        if ( objectType != MP2::OBJ_HEROES ) {
+            result.assign( objects.begin(), objects.end() );
+        }
+
+        for ( const int32_t idx : objectIndex.getObjects( MP2::OBJ_HEROES ) ) {
+            if ( world.GetTiles( idx ).GetObject( false ) == objectType ) {
                 result.push_back( idx );
             }
         }
+
+        std::sort( result.begin(), result.end() );
+
         return result;
     }
 }
@@ -381,9 +407,23 @@ Maps::Indexes Maps::ScanAroundObject( const int32_t center, const MP2::MapObject
 
 Maps::Indexes Maps::ScanAroundObjectWithDistance( const int32_t center, const uint32_t dist, const MP2::MapObjectType objectType )
 {
-    Indexes results = getAroundIndexes( center, dist );
-    std::sort( results.begin(), results.end(), ComparisonDistance( center ) );
-    return MapsIndexesFilteredObject( results, objectType );
+    const MapObjectIndex & objectIndex = world.getObjectIndex();
+    if ( !objectIndex.isBuilt() ) {
+        Indexes results = getAroundIndexes( center, dist );
+        std::sort( results.begin(), results.end(), ComparisonDistance( center ) );
+        return MapsIndexesFilteredObject( results, objectType );
+    }
+
+    // Tiles without objects can't match so only tiles with objects are checked
+    Indexes results;
+    for ( const int32_t idx : objectIndex.getObjectsAround( center, static_cast<int32_t>( dist ) ) ) {
+        if ( world.GetTiles( idx ).GetObject( false ) == objectType ) {
+            results.push_back( idx );
+        }
+    }
+
+    std::stable_sort( results.begin(), results.end(), ComparisonDistance( center ) );
+    return results;
 }
 
 Maps::Indexes Maps::GetObjectPositions( const MP2::MapObjectType objectType, bool ignoreHeroes )
@@ -423,7 +463,7 @@ bool MapsTileIsUnderProtection( int32_t from, int32_t index ) /* from: center, i
 
 bool Maps::TileIsUnderProtection( int32_t center )
 {
-    return MP2::OBJ_MONSTER == world.GetTiles( center ).GetObject() ? true : !GetTilesUnderProtection( center ).empty();
+    return isValidAbsIndex( center ) && world.getTileProtection( center ) != Direction::UNKNOWN;
 }
 
 Maps::Indexes Maps::GetTilesUnderProtection( int32_t center )
@@ -432,44 +472,34 @@ Maps::Indexes Maps::GetTilesUnderProtection( int32_t center )
     if ( !isValidAbsIndex( center ) )
         return result;
 
-    result.reserve( 9 );
-    const int width = world.w();
-    const int x = center % width;
-    const int y = center / width;
-
-    auto validateAndInsert = [&result, &center]( const int index ) {
-        if ( MapsTileIsUnderProtection( center, index ) )
-            result.push_back( index );
-    };
-
-    if ( y > 0 ) {
-        if ( x > 0 )
-            validateAndInsert( center - width - 1 );
+    const int protection = world.getTileProtection( center );
+    if ( protection == Direction::UNKNOWN )
+        return result;
 
-        validateAndInsert( center - width );
+    // Tiles are listed row by row, heroes fight the first monster of the list
+    const int directions[] = { Direction::TOP_LEFT, Direction::TOP,         Direction::TOP_RIGHT, Direction::LEFT,        Direction::CENTER,
+                               Direction::RIGHT,    Direction::BOTTOM_LEFT, Direction::BOTTOM,    Direction::BOTTOM_RIGHT };
 
-        if ( x < width - 1 )
-            validateAndInsert( center - width + 1 );
+    for ( const int direction : directions ) {
+        if ( protection & direction ) {
+            result.push_back( direction == Direction::CENTER ? center : GetDirectionIndex( center, direction ) );
+        }
     }
 
-    if ( x > 0 )
-        validateAndInsert( center - 1 );
-    if ( MP2::OBJ_MONSTER == world.GetTiles( center ).GetObject() )
-        result.push_back( center );
-    if ( x < width - 1 )
-        validateAndInsert( center + 1 );
-
-    if ( y < world.h() - 1 ) {
-        if ( x > 0 )
-            validateAndInsert( center + width - 1 );
+    return result;
+}
 
-        validateAndInsert( center + width );
+int Maps::calculateTileProtection( const int32_t center )
+{
+    int protection = MP2::OBJ_MONSTER == world.GetTiles( center ).GetObject() ? Direction::CENTER : Direction::UNKNOWN;
 
-        if ( x < width - 1 )
-            validateAndInsert( center + width + 1 );
+    for ( const int direction : Direction::All() ) {
+        if ( isValidDirection( center, direction ) && MapsTileIsUnderProtection( center, GetDirectionIndex( center, direction ) ) ) {
+            protection |= direction;
+        }
     }
 
-    return result;
+    return protection;
 }
 
 uint32_t Maps::GetApproximateDistance( const int32_t pos1, const int32_t pos2 )
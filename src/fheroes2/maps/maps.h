@@ -69,9 +69,13 @@ namespace Maps
     Indexes ScanAroundObject( const int32_t center, const MP2::MapObjectType objectType, const bool ignoreHeroes );
     Indexes GetFreeIndexesAroundTile( const int32_t center );
 
+    // Both functions use the protection cached by World, see World::getTileProtection()
     Indexes GetTilesUnderProtection( int32_t center );
     bool TileIsUnderProtection( int32_t center );
 
+    // Calculates directions of the monsters attacking a hero on the tile (Direction::CENTER if the monster is on the tile itself)
+    int calculateTileProtection( const int32_t center );
+
     Indexes GetObjectPositions( const MP2::MapObjectType objectType, bool ignoreHeroes );
     Indexes GetObjectPositions( int32_t center, const MP2::MapObjectType objectType, bool ignoreHeroes );
 
@@ -696,6 +696,67 @@ std::pair<int, int> Maps::Tiles::ColorRaceFromHeroSprite( const uint32_t heroSpr
 }
 
 /* Maps::Addons */
+Maps::Addons::Addons( const Addons & addons )
+{
+    *this = addons;
+}
+
+Maps::Addons::Addons( Addons && addons ) noexcept
+{
+    *this = std::move( addons );
+}
+
+Maps::Addons & Maps::Addons::operator=( const Addons & addons )
+{
+    if ( this != &addons ) {
+        _size = 0;
+        reserve( addons._size );
+        std::copy( addons.begin(), addons.end(), data() );
+        _size = addons._size;
+    }
+
+    return *this;
+}
+
+Maps::Addons & Maps::Addons::operator=( Addons && addons ) noexcept
+{
+    if ( this == &addons ) {
+        return *this;
+    }
+
+    if ( addons._heap ) {
+        _heap = std::move( addons._heap );
+        _capacity = addons._capacity;
+    }
+    else {
+        _heap.reset();
+        _capacity = INLINE_CAPACITY;
+        std::copy( addons.begin(), addons.end(), _inline );
+    }
+
+    _size = addons._size;
+
+    addons._size = 0;
+    addons._capacity = INLINE_CAPACITY;
+
+    return *this;
+}
+
+void Maps::Addons::reserve( const size_t count )
+{
+    if ( count <= _capacity ) {
+        return;
+    }
+
+    const uint32_t capacity = static_cast<uint32_t>( std::max( count, static_cast<size_t>( _capacity ) * 2 ) );
+
+    std::unique_ptr<TilesAddon[]> heap( new TilesAddon[capacity] );
+    std::copy( begin(), end(), heap.get() );
+
+    _heap = std::move( heap );
+    _capacity = capacity;
+}
+
 void Maps::Addons::Remove( u32 uniq )
 {
     remove_if( [uniq]( const TilesAddon & v ) { return v.isUniq( uniq ); } );
@@ -796,8 +857,10 @@ MP2::MapObjectType Maps::Tiles::GetObject( bool ignoreObjectUnderHero /* true */
 
 void Maps::Tiles::SetObject( const MP2::MapObjectType objectType )
 {
+    world.updateObjectIndex( _index, static_cast<MP2::MapObjectType>( mp2_object ), objectType );
+
     mp2_object = objectType;
-    world.resetPathfinder();
+    world.invalidatePathfinderTile( _index );
 }
 
 void Maps::Tiles::setBoat( int direction )
@@ -931,6 +994,9 @@ void Maps::Tiles::setInitialPassability()
 
 void Maps::Tiles::updatePassability()
 {
+    // Cached pathfinding data is updated lazily so the tile can be invalidated before its passability is changed
+    world.invalidatePathfinderTile( _index );
+
     if ( !Maps::isValidDirection( _index, Direction::LEFT ) ) {
         tilePassable &= ~( Direction::LEFT | Direction::TOP_LEFT | Direction::BOTTOM_LEFT );
     }
@@ -1656,8 +1722,10 @@ void Maps::Tiles::SetObjectPassable( bool pass )
         break;
 
     default:
-        break;
+        return;
     }
+
+    world.invalidatePathfinderTile( _index );
 }
 
 /* check road */
@@ -2200,7 +2268,14 @@ std::pair<uint32_t, uint32_t> Maps::Tiles::GetMonsterSpriteIndices( const Tiles
 
 void Maps::Tiles::ClearFog( int colors )
 {
+    if ( ( fog_colors & colors ) == 0 ) {
+        return;
+    }
+
     fog_colors &= ~colors;
+
+    // Fog affects tile passability
+    world.invalidatePathfinderTile( _index );
 }
 
 bool Maps::Tiles::isFogAllAround( const int color ) const
@@ -2713,6 +2788,35 @@ StreamBase & Maps::operator>>( StreamBase & msg, TilesAddon & ta )
     return msg;
 }
 
+StreamBase & Maps::operator<<( StreamBase & msg, const Addons & addons )
+{
+    // Same layout as std::list serialization to keep save files compatible.
+    msg.put32( static_cast<uint32_t>( addons.size() ) );
+
+    for ( const TilesAddon & addon : addons ) {
+        msg << addon;
+    }
+
+    return msg;
+}
+
+StreamBase & Maps::operator>>( StreamBase & msg, Addons & addons )
+{
+    const uint32_t size = msg.get32();
+
+    addons.clear();
+    addons.reserve( size );
+
+    for ( uint32_t i = 0; i < size; ++i ) {
+        TilesAddon addon;
+        msg >> addon;
+
+        addons.emplace_back( addon );
+    }
+
+    return msg;
+}
+
 StreamBase & Maps::operator<<( StreamBase & msg, const Tiles & tile )
 {
     return msg << tile._index << tile.pack_sprite_index << tile.tilePassable << tile.uniq << tile.objectTileset << tile.objectIndex << tile.mp2_object << tile.fog_colors
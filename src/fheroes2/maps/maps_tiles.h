@@ -22,7 +22,9 @@
 #ifndef H2TILES_H
 #define H2TILES_H
 
-#include <list>
+#include <algorithm>
+#include <iterator>
+#include <memory>
 
 #include "army_troop.h"
 #include "artifact.h"
@@ -66,7 +68,7 @@ namespace Maps
 
         ~TilesAddon() = default;
 
-        TilesAddon & operator=( const TilesAddon & ta ) = delete;
+        TilesAddon & operator=( const TilesAddon & ta ) = default;
 
         bool isUniq( const uint32_t id ) const
         {
@@ -92,9 +94,157 @@ namespace Maps
         uint8_t index;
     };
 
-    struct Addons : public std::list<TilesAddon>
+    // Addons of a tile are stored in a contiguous array. Most tiles have no more than two addons on a level,
+    // such addons are kept inside the object itself and the heap is used only for bigger objects.
+    class Addons
     {
+    public:
+        using iterator = TilesAddon *;
+        using const_iterator = const TilesAddon *;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        Addons() = default;
+        Addons( const Addons & addons );
+        Addons( Addons && addons ) noexcept;
+
+        ~Addons() = default;
+
+        Addons & operator=( const Addons & addons );
+        Addons & operator=( Addons && addons ) noexcept;
+
+        iterator begin()
+        {
+            return data();
+        }
+
+        iterator end()
+        {
+            return data() + _size;
+        }
+
+        const_iterator begin() const
+        {
+            return data();
+        }
+
+        const_iterator end() const
+        {
+            return data() + _size;
+        }
+
+        reverse_iterator rbegin()
+        {
+            return reverse_iterator( end() );
+        }
+
+        reverse_iterator rend()
+        {
+            return reverse_iterator( begin() );
+        }
+
+        const_reverse_iterator rbegin() const
+        {
+            return const_reverse_iterator( end() );
+        }
+
+        const_reverse_iterator rend() const
+        {
+            return const_reverse_iterator( begin() );
+        }
+
+        size_t size() const
+        {
+            return _size;
+        }
+
+        bool empty() const
+        {
+            return _size == 0;
+        }
+
+        TilesAddon & back()
+        {
+            return data()[_size - 1];
+        }
+
+        const TilesAddon & back() const
+        {
+            return data()[_size - 1];
+        }
+
+        void clear()
+        {
+            _size = 0;
+        }
+
+        void pop_back()
+        {
+            --_size;
+        }
+
+        template <typename... Args>
+        void emplace_back( Args &&... args )
+        {
+            reserve( _size + 1 );
+            data()[_size] = TilesAddon( std::forward<Args>( args )... );
+            ++_size;
+        }
+
+        template <typename... Args>
+        void emplace_front( Args &&... args )
+        {
+            emplace_back( std::forward<Args>( args )... );
+            std::rotate( begin(), end() - 1, end() );
+        }
+
+        template <typename Predicate>
+        void remove_if( Predicate predicate )
+        {
+            _size = static_cast<uint32_t>( std::remove_if( begin(), end(), predicate ) - begin() );
+        }
+
+        // The sorting is stable as std::list::sort() so addons of the same level keep the order of the map.
+        template <typename Compare>
+        void sort( Compare compare )
+        {
+            TilesAddon * first = begin();
+            for ( uint32_t i = 1; i < _size; ++i ) {
+                const TilesAddon addon = first[i];
+
+                uint32_t j = i;
+                for ( ; j > 0 && compare( addon, first[j - 1] ); --j ) {
+                    first[j] = first[j - 1];
+                }
+
+                first[j] = addon;
+            }
+        }
+
+        void reserve( const size_t count );
+
         void Remove( u32 uniq );
+
+    private:
+        enum : uint32_t
+        {
+            INLINE_CAPACITY = 2
+        };
+
+        TilesAddon * data()
+        {
+            return _heap ? _heap.get() : _inline;
+        }
+
+        const TilesAddon * data() const
+        {
+            return _heap ? _heap.get() : _inline;
+        }
+
+        std::unique_ptr<TilesAddon[]> _heap;
+        uint32_t _size = 0;
+        uint32_t _capacity = INLINE_CAPACITY;
+        TilesAddon _inline[INLINE_CAPACITY];
     };
 
     class Tiles
@@ -237,6 +387,11 @@ namespace Maps
             return ( fog_colors & colors ) == colors;
         }
 
+        int GetFogColors() const
+        {
+            return fog_colors;
+        }
+
         bool isFogAllAround( const int color ) const;
         void ClearFog( int color );
 
@@ -370,8 +525,10 @@ namespace Maps
     };
 
     StreamBase & operator<<( StreamBase &, const TilesAddon & );
+    StreamBase & operator<<( StreamBase &, const Addons & );
     StreamBase & operator<<( StreamBase &, const Tiles & );
     StreamBase & operator>>( StreamBase &, TilesAddon & );
+    StreamBase & operator>>( StreamBase &, Addons & );
     StreamBase & operator>>( StreamBase &, Tiles & );
 }
 
@@ -414,12 +414,14 @@ Monster Maps::Tiles::QuantityMonster( void ) const
         break;
     }
 
-    return MP2::isCaptureObject( GetObject( false ) ) ? Monster( world.GetCapturedObject( GetIndex() ).GetTroop().GetID() ) : Monster( Monster::UNKNOWN );
+    return MP2::isCaptureObject( GetObject( false ) ) ? Monster( static_cast<const World &>( world ).GetCapturedObject( GetIndex() ).GetTroop().GetID() )
+                                                      : Monster( Monster::UNKNOWN );
 }
 
 Troop Maps::Tiles::QuantityTroop( void ) const
 {
-    return MP2::isCaptureObject( GetObject( false ) ) ? world.GetCapturedObject( GetIndex() ).GetTroop() : Troop( QuantityMonster(), MonsterCount() );
+    return MP2::isCaptureObject( GetObject( false ) ) ? static_cast<const World &>( world ).GetCapturedObject( GetIndex() ).GetTroop()
+                                                      : Troop( QuantityMonster(), MonsterCount() );
 }
 
 void Maps::Tiles::QuantityReset( void )
@@ -934,6 +936,9 @@ void Maps::Tiles::MonsterSetCount( u32 count )
 {
     quantity1 = count >> 8;
     quantity2 = 0x00FF & count;
+
+    // Monster strength affects AI pathfinding
+    world.invalidatePathfinderTile( _index );
 }
 
 void Maps::Tiles::PlaceMonsterOnTile( Tiles & tile, const Monster & mons, const uint32_t count )
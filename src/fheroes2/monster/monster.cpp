@@ -21,6 +21,7 @@
  ***************************************************************************/
 
 #include <cmath>
+#include <vector>
 
 #include "castle.h"
 #include "difficulty.h"
@@ -214,6 +215,18 @@ u32 Monster::GetGrown() const
 // Doesn't account for situational special bonuses such as spell immunity
 double Monster::GetMonsterStrength( int attack, int defense ) const
 {
+    // Everything except attack and defense depends only on the monster type so it is calculated once for all monsters.
+    static const std::vector<std::pair<double, double>> strengthFactors = []() {
+        std::vector<std::pair<double, double>> result;
+        result.reserve( WATER_ELEMENT + 1 );
+
+        for ( int monsterId = UNKNOWN; monsterId <= WATER_ELEMENT; ++monsterId ) {
+            result.emplace_back( Monster( monsterId ).getStrengthFactors() );
+        }
+
+        return result;
+    }();
+
     const fheroes2::MonsterBattleStats & battleStats = fheroes2::getMonsterData( id ).battleStats;
 
     // If no modified values were provided then re-calculate
@@ -225,6 +238,17 @@ double Monster::GetMonsterStrength( int attack, int defense ) const
         defense = battleStats.defense;
 
     const double attackDefense = 1.0 + attack * 0.1 + defense * 0.05;
+
+    const std::pair<double, double> factors = ( id >= UNKNOWN && id <= WATER_ELEMENT ) ? strengthFactors[id] : getStrengthFactors();
+
+    // Additonal HP and Damage effectiveness diminishes with every combat round; strictly x4 HP == x2 unit count
+    return factors.first * attackDefense * factors.second;
+}
+
+std::pair<double, double> Monster::getStrengthFactors() const
+{
+    const fheroes2::MonsterBattleStats & battleStats = fheroes2::getMonsterData( id ).battleStats;
+
     const double effectiveHP = battleStats.hp * ( ignoreRetaliation() ? 1.4 : 1 );
 
     double damagePotential = ( battleStats.damageMin + battleStats.damageMax ) / 2.0;
@@ -276,8 +300,7 @@ double Monster::GetMonsterStrength( int attack, int defense ) const
     const int speedDiff = battleStats.speed - Speed::AVERAGE;
     monsterSpecial += ( speedDiff < 0 ) ? speedDiff * 0.1 : speedDiff * 0.05;
 
-    // Additonal HP and Damage effectiveness diminishes with every combat round; strictly x4 HP == x2 unit count
-    return sqrt( damagePotential * effectiveHP ) * attackDefense * monsterSpecial;
+    return std::make_pair( sqrt( damagePotential * effectiveHP ), monsterSpecial );
 }
 
 u32 Monster::GetRNDSize( bool skip_factor ) const
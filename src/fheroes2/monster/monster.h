@@ -23,6 +23,8 @@
 #ifndef H2MONSTER_H
 #define H2MONSTER_H
 
+#include <utility>
+
 #include "monster_info.h"
 #include "payment.h"
 
@@ -204,6 +206,9 @@ public:
 protected:
     static Monster FromDwelling( int race, u32 dw );
 
+    // Returns the strength of the monster without attack and defense and the multiplier of its special abilities.
+    std::pair<double, double> getStrengthFactors() const;
+
     int id;
 };
 
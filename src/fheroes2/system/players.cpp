@@ -445,6 +445,13 @@ void Players::SetStartGame( void )
     DEBUG_LOG( DBG_GAME, DBG_INFO, String() );
 }
 
+void Players::SetAllControlAI()
+{
+    for_each( begin(), end(), []( Player * player ) { player->SetControl( CONTROL_AI ); } );
+
+    human_colors = Color::NONE;
+}
+
 int Players::HumanColors( void )
 {
     if ( 0 == human_colors )
@@ -162,6 +162,8 @@ public:
     void clear( void );
 
     void SetStartGame( void );
+    // Hands all players over to AI, used by the headless simulation mode.
+    void SetAllControlAI();
     int GetColors( int control = 0xFF, bool strong = false ) const;
     int GetActualColors( void ) const;
     std::string String( void ) const;
@@ -92,6 +92,8 @@ Settings::Settings()
     , music_volume( 6 )
     , _musicType( MUSIC_EXTERNAL )
     , _controllerPointerSpeed( 10 )
+    , _imageCacheSize( 0 )
+    , _saveCompressionLevel( 6 )
     , heroes_speed( DEFAULT_SPEED_DELAY )
     , ai_speed( DEFAULT_SPEED_DELAY )
     , scroll_speed( SCROLL_NORMAL )
@@ -298,6 +300,14 @@ bool Settings::Read( const std::string & filename )
         _controllerPointerSpeed = clamp( config.IntParams( "controller pointer speed" ), 0, 100 );
     }
 
+    if ( config.Exists( "image cache size" ) ) {
+        _imageCacheSize = std::max( config.IntParams( "image cache size" ), 0 );
+    }
+
+    if ( config.Exists( "save compression level" ) ) {
+        _saveCompressionLevel = clamp( config.IntParams( "save compression level" ), 1, 9 );
+    }
+
     if ( config.Exists( "first time game run" ) && config.StrParams( "first time game run" ) == "off" ) {
         resetFirstGameRun();
     }
@@ -439,6 +449,12 @@ std::string Settings::String() const
     os << std::endl << "# enable V-Sync (Vertical Synchronization) for rendering" << std::endl;
     os << "v-sync = " << ( opt_global.Modes( GLOBAL_RENDER_VSYNC ) ? "on" : "off" ) << std::endl;
 
+    os << std::endl << "# memory limit of decoded images in megabytes, least recently used images are released above it (0 means no limit)" << std::endl;
+    os << "image cache size = " << _imageCacheSize << std::endl;
+
+    os << std::endl << "# compression level of saved games: 1 (fastest) - 9 (smallest files)" << std::endl;
+    os << "save compression level = " << _saveCompressionLevel << std::endl;
+
     return os.str();
 }
 
@@ -903,6 +919,16 @@ int Settings::controllerPointerSpeed() const
     return _controllerPointerSpeed;
 }
 
+int Settings::imageCacheSize() const
+{
+    return _imageCacheSize;
+}
+
+int Settings::saveCompressionLevel() const
+{
+    return _saveCompressionLevel;
+}
+
 void Settings::EnablePriceOfLoyaltySupport( const bool set )
 {
     if ( set ) {
@@ -265,6 +265,10 @@ public:
     fheroes2::Point LossMapsPositionObject() const;
     u32 LossCountDays() const;
     int controllerPointerSpeed() const;
+    // Returns the memory budget of decoded images in megabytes, 0 means no limit.
+    int imageCacheSize() const;
+    // Returns zlib compression level of save files from 1 (fastest) to 9 (smallest files).
+    int saveCompressionLevel() const;
 
     void SetMapsFile( const std::string & file );
 
@@ -312,6 +316,8 @@ private:
     int music_volume;
     MusicSource _musicType;
     int _controllerPointerSpeed;
+    int _imageCacheSize;
+    int _saveCompressionLevel;
     int heroes_speed;
     int ai_speed;
     int scroll_speed;
@@ -39,10 +39,13 @@
 #include "mp2.h"
 #include "pairs.h"
 #include "race.h"
+#include "rand.h"
 #include "resource.h"
 #include "save_format_version.h"
 #include "serialize.h"
 #include "settings.h"
+#include "thread_pool.h"
+#include "timing.h"
 #include "tools.h"
 #include "world.h"
 
@@ -125,6 +128,14 @@ namespace
 
         return count;
     }
+
+    template <typename Phase>
+    void runTimedPhase( double & duration, const Phase & phase )
+    {
+        const fheroes2::Time timer;
+        phase();
+        duration += timer.get();
+    }
 }
 
 namespace GameStatic
@@ -191,13 +202,32 @@ void MapObjects::remove( u32 uid )
 
 CapturedObject & CapturedObjects::Get( s32 index )
 {
-    std::map<s32, CapturedObject> & my = *this;
-    return my[index];
+    const std::pair<iterator, bool> result = emplace( index, CapturedObject() );
+    if ( result.second ) {
+        changeCounters( index, result.first->second.objcol, true );
+    }
+
+    return result.first->second;
+}
+
+const CapturedObject & CapturedObjects::Get( s32 index ) const
+{
+    const_iterator it = find( index );
+    if ( it != end() ) {
+        return it->second;
+    }
+
+    static const CapturedObject emptyObject;
+    return emptyObject;
 }
 
 void CapturedObjects::SetColor( s32 index, int col )
 {
-    Get( index ).SetColor( col );
+    CapturedObject & co = Get( index );
+
+    changeCounters( index, co.objcol, false );
+    co.SetColor( col );
+    changeCounters( index, co.objcol, true );
 }
 
 void CapturedObjects::Set( s32 index, int obj, int col )
@@ -207,52 +237,108 @@ void CapturedObjects::Set( s32 index, int obj, int col )
     if ( co.GetColor() != col && co.guardians.isValid() )
         co.guardians.Reset();
 
+    changeCounters( index, co.objcol, false );
     co.Set( obj, col );
+    changeCounters( index, co.objcol, true );
 }
 
-u32 CapturedObjects::GetCount( int obj, int col ) const
+void CapturedObjects::clear()
 {
-    u32 result = 0;
+    std::map<s32, CapturedObject>::clear();
+    updateCounters();
+}
 
-    const ObjectColor objcol( obj, col );
+void CapturedObjects::updateCounters()
+{
+    for ( std::array<uint32_t, 256> & counts : _objectCount ) {
+        counts.fill( 0 );
+    }
+    for ( std::array<uint32_t, MINE_TYPE_COUNT> & counts : _mineCount ) {
+        counts.fill( 0 );
+    }
 
     for ( const_iterator it = begin(); it != end(); ++it ) {
-        if ( objcol == ( *it ).second.objcol )
-            ++result;
+        changeCounters( it->first, it->second.objcol, true );
     }
+}
 
-    return result;
+void CapturedObjects::changeCounters( const s32 index, const ObjectColor & objcol, const bool isAdded )
+{
+    const size_t colorSlot = getColorSlot( objcol.second );
+    if ( colorSlot >= COLOR_SLOT_COUNT || objcol.first < 0 || objcol.first >= static_cast<int>( _objectCount[colorSlot].size() ) ) {
+        return;
+    }
+
+    uint32_t & objectCount = _objectCount[colorSlot][objcol.first];
+    objectCount = isAdded ? objectCount + 1 : objectCount - 1;
+
+    if ( objcol.first != MP2::OBJ_MINES && objcol.first != MP2::OBJ_HEROES ) {
+        return;
+    }
+
+    // The mine sprite is set before the mine is captured and never changes afterwards
+    const uint8_t mineType = world.GetTiles( index ).GetObjectSpriteIndex();
+    if ( mineType < MINE_TYPE_COUNT ) {
+        uint32_t & mineCount = _mineCount[colorSlot][mineType];
+        mineCount = isAdded ? mineCount + 1 : mineCount - 1;
+    }
 }
 
-u32 CapturedObjects::GetCountMines( int type, int col ) const
+size_t CapturedObjects::getColorSlot( const int color )
+{
+    switch ( color ) {
+    case Color::NONE:
+        return COLOR_SLOT_NONE;
+    case Color::UNUSED:
+        return COLOR_SLOT_UNUSED;
+    case Color::BLUE:
+    case Color::GREEN:
+    case Color::RED:
+    case Color::YELLOW:
+    case Color::ORANGE:
+    case Color::PURPLE:
+        return static_cast<size_t>( Color::GetIndex( color ) );
+    default:
+        break;
+    }
+
+    return COLOR_SLOT_COUNT;
+}
+
+u32 CapturedObjects::GetCount( int obj, int col ) const
 {
-    u32 result = 0;
+    const size_t colorSlot = getColorSlot( col );
+    if ( colorSlot >= COLOR_SLOT_COUNT || obj < 0 || obj >= static_cast<int>( _objectCount[colorSlot].size() ) ) {
+        return 0;
+    }
 
-    const ObjectColor objcol1( MP2::OBJ_MINES, col );
-    const ObjectColor objcol2( MP2::OBJ_HEROES, col );
+    return _objectCount[colorSlot][obj];
+}
 
-    for ( const_iterator it = begin(); it != end(); ++it ) {
-        const ObjectColor & objcol = ( *it ).second.objcol;
+u32 CapturedObjects::GetCountMines( int type, int col ) const
+{
+    const size_t colorSlot = getColorSlot( col );
+    if ( colorSlot >= COLOR_SLOT_COUNT ) {
+        return 0;
+    }
 
-        if ( objcol == objcol1 || objcol == objcol2 ) {
-            // scan for find mines
-            const uint8_t index = world.GetTiles( ( *it ).first ).GetObjectSpriteIndex();
-
-            // index sprite EXTRAOVR
-            if ( 0 == index && Resource::ORE == type )
-                ++result;
-            else if ( 1 == index && Resource::SULFUR == type )
-                ++result;
-            else if ( 2 == index && Resource::CRYSTAL == type )
-                ++result;
-            else if ( 3 == index && Resource::GEMS == type )
-                ++result;
-            else if ( 4 == index && Resource::GOLD == type )
-                ++result;
-        }
+    // index sprite EXTRAOVR
+    switch ( type ) {
+    case Resource::ORE:
+        return _mineCount[colorSlot][0];
+    case Resource::SULFUR:
+        return _mineCount[colorSlot][1];
+    case Resource::CRYSTAL:
+        return _mineCount[colorSlot][2];
+    case Resource::GEMS:
+        return _mineCount[colorSlot][3];
+    case Resource::GOLD:
+        return _mineCount[colorSlot][4];
+    default:
+        break;
     }
 
-    return result;
+    return 0;
 }
 
 int CapturedObjects::GetColor( s32 index ) const
@@ -295,7 +381,9 @@ void CapturedObjects::ResetColor( int color )
         if ( objcol.isColor( color ) ) {
             const MP2::MapObjectType objectType = static_cast<MP2::MapObjectType>( objcol.first );
 
+            changeCounters( it->first, objcol, false );
             objcol.second = objectType == MP2::OBJ_CASTLE ? Color::UNUSED : Color::NONE;
+            changeCounters( it->first, objcol, true );
             world.GetTiles( ( *it ).first ).CaptureFlags32( objectType, objcol.second );
         }
     }
@@ -372,6 +460,7 @@ void World::Reset( void )
     map_captureobj.clear();
     map_actions.clear();
     map_objects.clear();
+    _objectIndex.clear();
 
     ultimate_artifact.Reset();
 
@@ -644,6 +733,8 @@ void World::pickRumor()
 /* new day */
 void World::NewDay( void )
 {
+    _newDayTimings = NewDayTimings();
+
     ++day;
 
     if ( BeginWeek() ) {
@@ -658,31 +749,33 @@ void World::NewDay( void )
 
     // first the routine of the new month
     if ( BeginMonth() ) {
-        NewMonth();
-
-        vec_kingdoms.NewMonth();
-        vec_castles.NewMonth();
-        vec_heroes.NewMonth();
+        runTimedPhase( _newDayTimings.mapObjects, [this]() { NewMonth(); } );
+        runTimedPhase( _newDayTimings.kingdoms, [this]() { vec_kingdoms.NewMonth(); } );
+        runTimedPhase( _newDayTimings.castles, [this]() { vec_castles.NewMonth(); } );
+        runTimedPhase( _newDayTimings.heroes, [this]() { vec_heroes.NewMonth(); } );
     }
 
     // then the routine of the new week
     if ( BeginWeek() ) {
-        NewWeek();
-
-        vec_kingdoms.NewWeek();
-        vec_castles.NewWeek();
-        vec_heroes.NewWeek();
+        runTimedPhase( _newDayTimings.mapObjects, [this]() { NewWeek(); } );
+        runTimedPhase( _newDayTimings.kingdoms, [this]() { vec_kingdoms.NewWeek(); } );
+        runTimedPhase( _newDayTimings.castles, [this]() { vec_castles.NewWeek(); } );
+        runTimedPhase( _newDayTimings.heroes, [this]() { vec_heroes.NewWeek(); } );
     }
 
     // and finally the routine of the new day
-    vec_kingdoms.NewDay();
-    vec_castles.NewDay();
-    vec_heroes.NewDay();
+    runTimedPhase( _newDayTimings.kingdoms, [this]() { vec_kingdoms.NewDay(); } );
+    runTimedPhase( _newDayTimings.castles, [this]() { vec_castles.NewDay(); } );
+    runTimedPhase( _newDayTimings.heroes, [this]() { vec_heroes.NewDay(); } );
 
     // remove deprecated events
     assert( day > 0 );
 
     vec_eventsday.remove_if( [this]( const EventDate & v ) { return v.isDeprecated( day - 1 ); } );
+
+    DEBUG_LOG( DBG_GAME, DBG_INFO,
+               "New day timings, map objects: " << _newDayTimings.mapObjects << " s, kingdoms: " << _newDayTimings.kingdoms << " s, castles: " << _newDayTimings.castles
+                                                << " s, heroes: " << _newDayTimings.heroes << " s" );
 }
 
 void World::NewWeek( void )
@@ -700,11 +793,7 @@ void World::NewWeek( void )
 
     // update objects
     if ( week > 1 ) {
-        for ( Maps::Tiles & tile : vec_tiles ) {
-            if ( MP2::isWeekLife( ( tile ).GetObject( false ) ) || tile.GetObject() == MP2::OBJ_MONSTER ) {
-                tile.QuantityUpdate( false );
-            }
-        }
+        updateWeekObjects();
     }
 
     // add events
@@ -715,6 +804,51 @@ void World::NewWeek( void )
     }
 }
 
+void World::updateWeekObjects()
+{
+    // Tiles are split into blocks which are updated in parallel. The updates of week life objects and monsters change only the tile itself,
+    // the pathfinders are updated afterwards.
+    const size_t blockSize = 1024;
+    const size_t blockCount = ( vec_tiles.size() + blockSize - 1 ) / blockSize;
+
+    std::vector<std::vector<int32_t>> updatedTiles( blockCount );
+
+    // Every tile gets its own random generator seed so the result does not depend on the number of threads and the order of the updates.
+    // The generator of the calling thread is used by the pool as well, its state is restored afterwards.
+    const std::mt19937 callingThreadGenerator = Rand::CurrentThreadRandomDevice();
+
+    _isPathfinderInvalidationDeferred = true;
+
+    fheroes2::getThreadPool().parallelFor( blockCount, [this, blockSize, &updatedTiles]( const size_t blockId ) {
+        const size_t blockEnd = std::min( vec_tiles.size(), ( blockId + 1 ) * blockSize );
+        std::mt19937 & generator = Rand::CurrentThreadRandomDevice();
+
+        for ( size_t idx = blockId * blockSize; idx < blockEnd; ++idx ) {
+            Maps::Tiles & tile = vec_tiles[idx];
+            if ( !MP2::isWeekLife( tile.GetObject( false ) ) && tile.GetObject() != MP2::OBJ_MONSTER ) {
+                continue;
+            }
+
+            size_t tileSeed = _weekSeed;
+            fheroes2::hashCombine( tileSeed, idx );
+            generator.seed( static_cast<uint32_t>( tileSeed ) );
+
+            tile.QuantityUpdate( false );
+            updatedTiles[blockId].push_back( static_cast<int32_t>( idx ) );
+        }
+    } );
+
+    _isPathfinderInvalidationDeferred = false;
+
+    Rand::CurrentThreadRandomDevice() = callingThreadGenerator;
+
+    for ( const std::vector<int32_t> & tiles : updatedTiles ) {
+        for ( const int32_t idx : tiles ) {
+            invalidatePathfinderTile( idx );
+        }
+    }
+}
+
 void World::NewMonth( void )
 {
     if ( month > 1 && week_current.GetType() == WeekName::MONSTERS ) {
@@ -957,6 +1091,9 @@ void World::CaptureObject( s32 index, int color )
     const MP2::MapObjectType objectType = GetTiles( index ).GetObject( false );
     map_captureobj.Set( index, objectType, color );
 
+    // Guardians are removed when the owner changes, they affect AI pathfinding
+    invalidatePathfinderTile( index );
+
     Castle * castle = getCastleEntrance( Maps::GetPoint( index ) );
     if ( castle && castle->GetColor() != color )
         castle->ChangeColor( color );
@@ -982,6 +1119,11 @@ CapturedObject & World::GetCapturedObject( s32 index )
     return map_captureobj.Get( index );
 }
 
+const CapturedObject & World::GetCapturedObject( s32 index ) const
+{
+    return map_captureobj.Get( index );
+}
+
 void World::ResetCapturedObjects( int color )
 {
     map_captureobj.ResetColor( color );
@@ -1311,10 +1453,24 @@ std::list<Route::Step> World::getPath( const Heroes & hero, int targetIndex )
 
 void World::resetPathfinder()
 {
+    _pathfindingSnapshot.reset();
+    _regionPathfinder.reset();
     _pathfinder.reset();
     AI::Get().resetPathfinder();
 }
 
+void World::invalidatePathfinderTile( const int32_t tileIndex )
+{
+    if ( _isPathfinderInvalidationDeferred ) {
+        return;
+    }
+
+    _pathfindingSnapshot.invalidate( tileIndex );
+    _regionPathfinder.invalidateTile( tileIndex );
+    _pathfinder.invalidateTile( tileIndex );
+    AI::Get().invalidatePathfinderTile( tileIndex );
+}
+
 void World::PostLoad( const bool setTilePassabilities )
 {
     if ( setTilePassabilities ) {
@@ -1330,6 +1486,9 @@ void World::PostLoad( const bool setTilePassabilities )
         }
     }
 
+    _objectIndex.build();
+    map_captureobj.updateCounters();
+
     // cache data that's accessed often
     _allTeleporters = Maps::GetObjectPositions( MP2::OBJ_STONELITHS, true );
     _whirlpoolTiles = Maps::GetObjectPositions( MP2::OBJ_WHIRLPOOL, true );
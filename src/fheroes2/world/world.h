@@ -22,6 +22,7 @@
 #ifndef H2WORLD_H
 #define H2WORLD_H
 
+#include <array>
 #include <string>
 #include <vector>
 
@@ -31,6 +32,7 @@
 #include "maps.h"
 #include "maps_tiles.h"
 #include "week.h"
+#include "world_object_index.h"
 #include "world_pathfinding.h"
 #include "world_regions.h"
 
@@ -89,6 +91,10 @@ struct CapturedObject
     {
         return guardians;
     }
+    const Troop & GetTroop( void ) const
+    {
+        return guardians;
+    }
 
     void Set( int obj, int col )
     {
@@ -104,6 +110,7 @@ struct CapturedObject
     }
 };
 
+// Object colors have to be changed only by the methods below, they keep the object counters up to date
 struct CapturedObjects : std::map<s32, CapturedObject>
 {
     void Set( s32, int, int );
@@ -112,12 +119,41 @@ struct CapturedObjects : std::map<s32, CapturedObject>
     void ResetColor( int );
 
     CapturedObject & Get( s32 );
+    // Read-only access does not add missing objects so it is safe to be used from several threads
+    const CapturedObject & Get( s32 ) const;
 
     void tributeCapturedObjects( const int playerColorId, const int objectType, Funds & funds, int & objectCount );
 
     u32 GetCount( int, int ) const;
     u32 GetCountMines( int, int ) const;
     int GetColor( s32 ) const;
+
+    void clear();
+
+    // Recounts all objects, it has to be called once the objects are loaded
+    void updateCounters();
+
+private:
+    void changeCounters( const s32 index, const ObjectColor & objcol, const bool isAdded );
+
+    // Colors are indexed by Color::GetIndex() followed by Color::NONE and Color::UNUSED
+    enum : size_t
+    {
+        COLOR_SLOT_NONE = 6,
+        COLOR_SLOT_UNUSED = 7,
+        COLOR_SLOT_COUNT = 8
+    };
+
+    // Mines are distinguished by the sprite index of EXTRAOVR: ore, sulfur, crystal, gems and gold
+    enum : size_t
+    {
+        MINE_TYPE_COUNT = 5
+    };
+
+    static size_t getColorSlot( const int color );
+
+    std::array<std::array<uint32_t, 256>, COLOR_SLOT_COUNT> _objectCount{};
+    std::array<std::array<uint32_t, MINE_TYPE_COUNT>, COLOR_SLOT_COUNT> _mineCount{};
 };
 
 struct EventDate
@@ -231,10 +267,24 @@ public:
     const Week & GetWeekType( void ) const;
     std::string DateString( void ) const;
 
+    // Durations of the phases of the last NewDay() call in seconds
+    struct NewDayTimings
+    {
+        double mapObjects = 0;
+        double kingdoms = 0;
+        double castles = 0;
+        double heroes = 0;
+    };
+
     void NewDay( void );
     void NewWeek( void );
     void NewMonth( void );
 
+    const NewDayTimings & getNewDayTimings() const
+    {
+        return _newDayTimings;
+    }
+
     const std::string & GetRumors( void );
 
     s32 NextTeleport( s32 ) const;
@@ -250,6 +300,7 @@ public:
     int ColorCapturedObject( s32 ) const;
     void ResetCapturedObjects( int );
     CapturedObject & GetCapturedObject( s32 );
+    const CapturedObject & GetCapturedObject( s32 ) const;
     ListActions * GetListActions( s32 );
 
     void ActionForMagellanMaps( int color );
@@ -275,6 +326,41 @@ public:
     uint32_t getDistance( const Heroes & hero, int targetIndex );
     std::list<Route::Step> getPath( const Heroes & hero, int targetIndex );
     void resetPathfinder();
+    void invalidatePathfinderTile( const int32_t tileIndex );
+
+    // Snapshot has to be updated before use if tiles have been modified
+    void updatePathfindingSnapshot()
+    {
+        _pathfindingSnapshot.update();
+    }
+
+    const WorldMapSnapshot & getPathfindingSnapshot() const
+    {
+        return _pathfindingSnapshot;
+    }
+
+    // Directions of the monsters attacking a hero on the tile, Direction::CENTER is set if the monster is on the tile itself
+    int getTileProtection( const int32_t tileIndex )
+    {
+        _pathfindingSnapshot.update();
+        return _pathfindingSnapshot.getProtection( tileIndex );
+    }
+
+    const MapObjectIndex & getObjectIndex() const
+    {
+        return _objectIndex;
+    }
+
+    void updateObjectIndex( const int32_t tileIndex, const MP2::MapObjectType previousType, const MP2::MapObjectType newType )
+    {
+        _objectIndex.update( tileIndex, previousType, newType );
+    }
+
+    // Fast approximate distances between distant tiles
+    RegionPathfinder & getRegionPathfinder()
+    {
+        return _regionPathfinder;
+    }
 
     void ComputeStaticAnalysis();
     static u32 GetUniq( void );
@@ -293,6 +379,7 @@ private:
     void Defaults( void );
     void Reset( void );
     void MonthOfMonstersAction( const Monster & );
+    void updateWeekObjects();
     void ProcessNewMap();
     void PostLoad( const bool setTilePassabilities );
     void pickRumor();
@@ -334,9 +421,16 @@ private:
     Maps::Indexes _whirlpoolTiles;
     std::vector<MapRegion> _regions;
     PlayerWorldPathfinder _pathfinder;
+    WorldMapSnapshot _pathfindingSnapshot;
+    RegionPathfinder _regionPathfinder;
+    MapObjectIndex _objectIndex;
 
     uint32_t _seed{ 0 }; // global seed for the map
     size_t _weekSeed{ 0 }; // global seed for the map, for this week
+
+    NewDayTimings _newDayTimings;
+    // Tiles are being updated in parallel, they are invalidated in the pathfinders once the update is finished
+    bool _isPathfinderInvalidationDeferred = false;
 };
 
 StreamBase & operator<<( StreamBase &, const CapturedObject & );
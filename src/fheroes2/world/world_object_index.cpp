@@ -0,0 +1,149 @@
+/***************************************************************************
+ *   Free Heroes of Might and Magic II: https://github.com/ihhub/fheroes2  *
+ *   Copyright (C) 2021                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <algorithm>
+#include <cassert>
+
+#include "world.h"
+#include "world_object_index.h"
+
+void MapObjectIndex::build()
+{
+    clear();
+
+    const int32_t width = world.w();
+    const int32_t height = world.h();
+
+    _cellColumns = ( width + _cellSize - 1 ) / _cellSize;
+    _cells.resize( static_cast<size_t>( _cellColumns ) * ( ( height + _cellSize - 1 ) / _cellSize ) );
+    _isBuilt = true;
+
+    const int32_t worldSize = static_cast<int32_t>( world.getSize() );
+    for ( int32_t idx = 0; idx < worldSize; ++idx ) {
+        add( idx, world.GetTiles( idx ).GetObject() );
+    }
+}
+
+void MapObjectIndex::clear()
+{
+    for ( std::set<int32_t> & objects : _objectsByType ) {
+        objects.clear();
+    }
+
+    _cells.clear();
+    _cellColumns = 0;
+    _isBuilt = false;
+}
+
+void MapObjectIndex::update( const int32_t tileIndex, const MP2::MapObjectType previousType, const MP2::MapObjectType newType )
+{
+    // Objects are set before the index is built while the map is being loaded
+    if ( !_isBuilt || previousType == newType ) {
+        return;
+    }
+
+    remove( tileIndex, previousType );
+    add( tileIndex, newType );
+}
+
+std::vector<int32_t> MapObjectIndex::getObjects( const std::function<bool( const MP2::MapObjectType )> & filter ) const
+{
+    std::vector<int32_t> result;
+
+    for ( size_t objectType = MP2::OBJ_ZERO + 1; objectType < _objectsByType.size(); ++objectType ) {
+        if ( !_objectsByType[objectType].empty() && filter( static_cast<MP2::MapObjectType>( objectType ) ) ) {
+            result.insert( result.end(), _objectsByType[objectType].begin(), _objectsByType[objectType].end() );
+        }
+    }
+
+    std::sort( result.begin(), result.end() );
+
+    return result;
+}
+
+std::vector<int32_t> MapObjectIndex::getObjectsAround( const int32_t center, const int32_t distance ) const
+{
+    std::vector<int32_t> result;
+
+    if ( !_isBuilt || !Maps::isValidAbsIndex( center ) || distance <= 0 ) {
+        return result;
+    }
+
+    const int32_t width = world.w();
+    const int32_t height = world.h();
+    const int32_t centerX = center % width;
+    const int32_t centerY = center / width;
+
+    const int32_t minX = std::max( centerX - distance, 0 );
+    const int32_t maxX = std::min( centerX + distance, width - 1 );
+    const int32_t minY = std::max( centerY - distance, 0 );
+    const int32_t maxY = std::min( centerY + distance, height - 1 );
+
+    for ( int32_t cellY = minY / _cellSize; cellY <= maxY / _cellSize; ++cellY ) {
+        for ( int32_t cellX = minX / _cellSize; cellX <= maxX / _cellSize; ++cellX ) {
+            for ( const int32_t idx : _cells[cellY * _cellColumns + cellX] ) {
+                const int32_t x = idx % width;
+                const int32_t y = idx / width;
+
+                if ( idx != center && x >= minX && x <= maxX && y >= minY && y <= maxY ) {
+                    result.push_back( idx );
+                }
+            }
+        }
+    }
+
+    std::sort( result.begin(), result.end() );
+
+    return result;
+}
+
+void MapObjectIndex::add( const int32_t tileIndex, const MP2::MapObjectType objectType )
+{
+    if ( objectType == MP2::OBJ_ZERO ) {
+        return;
+    }
+
+    _objectsByType[objectType].insert( tileIndex );
+    _cells[getCellId( tileIndex )].push_back( tileIndex );
+}
+
+void MapObjectIndex::remove( const int32_t tileIndex, const MP2::MapObjectType objectType )
+{
+    if ( objectType == MP2::OBJ_ZERO ) {
+        return;
+    }
+
+    _objectsByType[objectType].erase( tileIndex );
+
+    std::vector<int32_t> & cell = _cells[getCellId( tileIndex )];
+    const auto cellIt = std::find( cell.begin(), cell.end(), tileIndex );
+    if ( cellIt != cell.end() ) {
+        *cellIt = cell.back();
+        cell.pop_back();
+    }
+}
+
+int32_t MapObjectIndex::getCellId( const int32_t tileIndex ) const
+{
+    const int32_t width = world.w();
+    assert( width > 0 );
+
+    return ( tileIndex / width / _cellSize ) * _cellColumns + ( tileIndex % width ) / _cellSize;
+}
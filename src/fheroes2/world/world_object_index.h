@@ -0,0 +1,74 @@
+/***************************************************************************
+ *   Free Heroes of Might and Magic II: https://github.com/ihhub/fheroes2  *
+ *   Copyright (C) 2021                                                    *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <vector>
+
+#include "mp2.h"
+
+// Index of the objects on the adventure map to find objects of a certain type or around a certain tile without scanning
+// all tiles. Objects are indexed by the type stored in the tile so heroes hide the objects under them.
+// The index is updated by Maps::Tiles::SetObject().
+class MapObjectIndex
+{
+public:
+    // Re-creates the index from the world tiles
+    void build();
+
+    void clear();
+
+    void update( const int32_t tileIndex, const MP2::MapObjectType previousType, const MP2::MapObjectType newType );
+
+    bool isBuilt() const
+    {
+        return _isBuilt;
+    }
+
+    // All tiles with the object of the given type sorted by index
+    const std::set<int32_t> & getObjects( const MP2::MapObjectType objectType ) const
+    {
+        return _objectsByType[objectType];
+    }
+
+    // Tiles with objects of all types accepted by the filter sorted by index
+    std::vector<int32_t> getObjects( const std::function<bool( const MP2::MapObjectType )> & filter ) const;
+
+    // Tiles with objects (except the center) within the distance by both axes from the center sorted by index
+    std::vector<int32_t> getObjectsAround( const int32_t center, const int32_t distance ) const;
+
+private:
+    // Tiles of the grid cell are stored unsorted
+    static const int32_t _cellSize = 8;
+
+    void add( const int32_t tileIndex, const MP2::MapObjectType objectType );
+    void remove( const int32_t tileIndex, const MP2::MapObjectType objectType );
+
+    int32_t getCellId( const int32_t tileIndex ) const;
+
+    std::array<std::set<int32_t>, 256> _objectsByType;
+    std::vector<std::vector<int32_t>> _cells;
+    int32_t _cellColumns = 0;
+    bool _isBuilt = false;
+};
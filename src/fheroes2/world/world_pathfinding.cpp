@@ -18,13 +18,18 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
 #include <set>
 
 #include "ground.h"
 #include "logging.h"
 #include "rand.h"
+#include "thread_pool.h"
 #include "world.h"
 #include "world_pathfinding.h"
 
@@ -46,7 +51,7 @@ bool isTileBlockedForArmy( int tileIndex, int color, double armyStrength, bool f
     }
 
     if ( objectType == MP2::OBJ_MONSTER || ( objectType == MP2::OBJ_ARTIFACT && tile.QuantityVariant() > 5 ) )
-        return Army( tile ).GetStrength() > armyStrength;
+        return world.getPathfindingSnapshot().getGuardStrength( tileIndex ) > armyStrength;
 
     // check if AI has the key for the barrier
     if ( objectType == MP2::OBJ_BARRIER && world.GetKingdom( color ).IsVisitTravelersTent( tile.QuantityColor() ) )
@@ -77,61 +82,250 @@ bool World::isTileBlocked( int tileIndex, bool fromWater ) const
     return false;
 }
 
-bool World::isValidPath( const int index, const int direction, const int heroColor ) const
+namespace
 {
-    const Maps::Tiles & fromTile = GetTiles( index );
-    const bool fromWater = fromTile.isWater();
+    // Pathfinding skill used to estimate the distances between regions
+    const uint8_t regionGraphPathfindingSkill = Skill::Level::EXPERT;
 
-    // check corner water/coast
-    if ( fromWater ) {
-        const int mapWidth = world.w();
-        switch ( direction ) {
-        case Direction::TOP_LEFT: {
-            assert( index >= mapWidth + 1 );
-            if ( GetTiles( index - mapWidth - 1 ).isWater() && ( !GetTiles( index - 1 ).isWater() || !GetTiles( index - mapWidth ).isWater() ) ) {
-                // Cannot sail through the corner of land.
-                return false;
-            }
+    // Movement cost between adjacent tiles without the "last move" logic
+    uint32_t getBaseMovementPenalty( const WorldMapSnapshot & snapshot, const int src, const int dst, const int direction, const uint8_t pathfindingSkill )
+    {
+        uint32_t penalty = snapshot.isRoad( src ) && snapshot.isRoad( dst ) ? Maps::Ground::roadPenalty : snapshot.getGroundPenalty( src, pathfindingSkill );
 
-            break;
+        // Diagonal movement costs 50% more
+        if ( Direction::isDiagonal( direction ) ) {
+            penalty = penalty * 3 / 2;
         }
-        case Direction::TOP_RIGHT: {
-            assert( index >= mapWidth && index + 1 < mapWidth * world.h() );
-            if ( GetTiles( index - mapWidth + 1 ).isWater() && ( !GetTiles( index + 1 ).isWater() || !GetTiles( index - mapWidth ).isWater() ) ) {
-                // Cannot sail through the corner of land.
-                return false;
+
+        return penalty;
+    }
+
+    // Checks the movement from the tile to the adjacent tile in the given direction without taking the fog into account
+    bool isValidPathIgnoringFog( const int index, const int direction )
+    {
+        const Maps::Tiles & fromTile = world.GetTiles( index );
+        const bool fromWater = fromTile.isWater();
+
+        // check corner water/coast
+        if ( fromWater ) {
+            const int mapWidth = world.w();
+            switch ( direction ) {
+            case Direction::TOP_LEFT: {
+                assert( index >= mapWidth + 1 );
+                if ( world.GetTiles( index - mapWidth - 1 ).isWater() && ( !world.GetTiles( index - 1 ).isWater() || !world.GetTiles( index - mapWidth ).isWater() ) ) {
+                    // Cannot sail through the corner of land.
+                    return false;
+                }
+
+                break;
             }
+            case Direction::TOP_RIGHT: {
+                assert( index >= mapWidth && index + 1 < mapWidth * world.h() );
+                if ( world.GetTiles( index - mapWidth + 1 ).isWater() && ( !world.GetTiles( index + 1 ).isWater() || !world.GetTiles( index - mapWidth ).isWater() ) ) {
+                    // Cannot sail through the corner of land.
+                    return false;
+                }
 
-            break;
-        }
-        case Direction::BOTTOM_RIGHT: {
-            assert( index + mapWidth + 1 < mapWidth * world.h() );
-            if ( GetTiles( index + mapWidth + 1 ).isWater() && ( !GetTiles( index + 1 ).isWater() || !GetTiles( index + mapWidth ).isWater() ) ) {
-                // Cannot sail through the corner of land.
-                return false;
+                break;
             }
+            case Direction::BOTTOM_RIGHT: {
+                assert( index + mapWidth + 1 < mapWidth * world.h() );
+                if ( world.GetTiles( index + mapWidth + 1 ).isWater() && ( !world.GetTiles( index + 1 ).isWater() || !world.GetTiles( index + mapWidth ).isWater() ) ) {
+                    // Cannot sail through the corner of land.
+                    return false;
+                }
 
-            break;
-        }
-        case Direction::BOTTOM_LEFT: {
-            assert( index >= 1 && index + mapWidth - 1 < mapWidth * world.h() );
-            if ( GetTiles( index + mapWidth - 1 ).isWater() && ( !GetTiles( index - 1 ).isWater() || !GetTiles( index + mapWidth ).isWater() ) ) {
-                // Cannot sail through the corner of land.
-                return false;
+                break;
             }
+            case Direction::BOTTOM_LEFT: {
+                assert( index >= 1 && index + mapWidth - 1 < mapWidth * world.h() );
+                if ( world.GetTiles( index + mapWidth - 1 ).isWater() && ( !world.GetTiles( index - 1 ).isWater() || !world.GetTiles( index + mapWidth ).isWater() ) ) {
+                    // Cannot sail through the corner of land.
+                    return false;
+                }
 
-            break;
+                break;
+            }
+            default:
+                break;
+            }
         }
-        default:
-            break;
+
+        if ( !fromTile.isPassable( direction, fromWater, true, Color::NONE ) )
+            return false;
+
+        const Maps::Tiles & toTile = world.GetTiles( Maps::GetDirectionIndex( index, direction ) );
+        return toTile.isPassable( Direction::Reflect( direction ), fromWater, true, Color::NONE );
+    }
+}
+
+bool World::isValidPath( const int index, const int direction, const int heroColor ) const
+{
+    if ( GetTiles( index ).isFog( heroColor ) || GetTiles( Maps::GetDirectionIndex( index, direction ) ).isFog( heroColor ) ) {
+        return false;
+    }
+
+    return isValidPathIgnoringFog( index, direction );
+}
+
+void WorldMapSnapshot::reset()
+{
+    _outdatedTiles.clear();
+    _isFullUpdateNeeded = true;
+}
+
+void WorldMapSnapshot::invalidate( const int32_t tileIndex )
+{
+    if ( _isFullUpdateNeeded ) {
+        return;
+    }
+
+    // Too many changes, it is cheaper to update the whole snapshot
+    if ( _outdatedTiles.size() >= _flags.size() / 8 ) {
+        reset();
+        return;
+    }
+
+    _outdatedTiles.push_back( tileIndex );
+}
+
+void WorldMapSnapshot::update()
+{
+    const int32_t worldSize = static_cast<int32_t>( world.getSize() );
+
+    if ( _isFullUpdateNeeded || _flags.size() != static_cast<size_t>( worldSize ) ) {
+        _passableDirections.resize( worldSize );
+        _fogColors.resize( worldSize );
+        _flags.resize( worldSize );
+        _objectTypes.resize( worldSize );
+        _protection.resize( worldSize );
+        _guards.resize( worldSize );
+        for ( std::vector<uint16_t> & penalties : _groundPenalty ) {
+            penalties.resize( worldSize );
+        }
+
+        for ( int32_t idx = 0; idx < worldSize; ++idx ) {
+            updateTile( idx );
+            updateGuard( idx );
+        }
+
+        // Passability and protection of a tile depend on its neighbours so they are updated once all tiles are up to date
+        for ( int32_t idx = 0; idx < worldSize; ++idx ) {
+            updatePassability( idx );
+            updateProtection( idx );
+        }
+
+        _outdatedTiles.clear();
+        _isFullUpdateNeeded = false;
+        return;
+    }
+
+    if ( _outdatedTiles.empty() ) {
+        return;
+    }
+
+    const Directions & directions = Direction::All();
+
+    for ( const int32_t idx : _outdatedTiles ) {
+        if ( idx >= 0 && idx < worldSize ) {
+            updateTile( idx );
+            updateGuard( idx );
         }
     }
 
-    if ( !fromTile.isPassable( direction, fromWater, false, heroColor ) )
+    for ( const int32_t idx : _outdatedTiles ) {
+        if ( idx < 0 || idx >= worldSize ) {
+            continue;
+        }
+
+        updatePassability( idx );
+        updateProtection( idx );
+
+        for ( const int direction : directions ) {
+            if ( Maps::isValidDirection( idx, direction ) ) {
+                const int32_t adjacentIndex = Maps::GetDirectionIndex( idx, direction );
+                updatePassability( adjacentIndex );
+                updateProtection( adjacentIndex );
+            }
+        }
+    }
+
+    _outdatedTiles.clear();
+}
+
+void WorldMapSnapshot::updateTile( const int32_t index )
+{
+    const Maps::Tiles & tile = world.GetTiles( index );
+
+    _fogColors[index] = static_cast<uint8_t>( tile.GetFogColors() );
+    _flags[index] = ( tile.isWater() ? TILE_WATER : 0 ) | ( tile.isRoad() ? TILE_ROAD : 0 );
+    _objectTypes[index] = static_cast<uint8_t>( tile.GetObject() );
+
+    for ( size_t level = 0; level < _groundPenalty.size(); ++level ) {
+        _groundPenalty[level][index] = static_cast<uint16_t>( Maps::Ground::GetPenalty( tile, static_cast<uint32_t>( level ) ) );
+    }
+}
+
+void WorldMapSnapshot::updatePassability( const int32_t index )
+{
+    uint8_t passableDirections = 0;
+
+    for ( const int direction : Direction::All() ) {
+        if ( Maps::isValidDirection( index, direction ) && isValidPathIgnoringFog( index, direction ) ) {
+            passableDirections |= static_cast<uint8_t>( direction );
+        }
+    }
+
+    _passableDirections[index] = passableDirections;
+}
+
+void WorldMapSnapshot::updateProtection( const int32_t index )
+{
+    _protection[index] = static_cast<uint16_t>( Maps::calculateTileProtection( index ) );
+}
+
+void WorldMapSnapshot::updateGuard( const int32_t index )
+{
+    const Maps::Tiles & tile = world.GetTiles( index );
+    const Troop troop = tile.QuantityTroop();
+
+    TileGuard & guard = _guards[index];
+    guard.monsterId = troop.GetID();
+    guard.monsterCount = troop.GetCount();
+    guard.object = static_cast<uint8_t>( tile.GetObject() );
+    guard.objectUnderHero = static_cast<uint8_t>( tile.GetObject( false ) );
+    guard.quantity1 = tile.GetQuantity1();
+    guard.quantity2 = tile.GetQuantity2();
+
+    if ( MP2::isProtectedObject( tile.GetObject() ) || MP2::isProtectedObject( tile.GetObject( false ) ) ) {
+        _guardArmy.setFromTile( tile );
+        guard.strength = _guardArmy.GetStrength();
+    }
+    else {
+        guard.strength = 0;
+    }
+}
+
+double WorldMapSnapshot::getGuardStrength( const int32_t index ) const
+{
+    const Maps::Tiles & tile = world.GetTiles( index );
+
+    if ( static_cast<size_t>( index ) < _guards.size() && _guards[index].isUpToDate( tile ) ) {
+        return _guards[index].strength;
+    }
+
+    // The snapshot has not been created yet or the tile has been changed without invalidation
+    return Army( tile ).GetStrength();
+}
+
+bool WorldMapSnapshot::TileGuard::isUpToDate( const Maps::Tiles & tile ) const
+{
+    if ( object != tile.GetObject() || objectUnderHero != tile.GetObject( false ) || quantity1 != tile.GetQuantity1() || quantity2 != tile.GetQuantity2() ) {
         return false;
+    }
 
-    const Maps::Tiles & toTile = GetTiles( Maps::GetDirectionIndex( index, direction ) );
-    return toTile.isPassable( Direction::Reflect( direction ), fromWater, false, heroColor );
+    const Troop troop = tile.QuantityTroop();
+    return monsterId == troop.GetID() && monsterCount == troop.GetCount();
 }
 
 void WorldPathfinder::checkWorldSize()
@@ -152,15 +346,11 @@ void WorldPathfinder::checkWorldSize()
 
 uint32_t WorldPathfinder::getMovementPenalty( int src, int dst, int direction ) const
 {
-    const Maps::Tiles & srcTile = world.GetTiles( src );
-    const Maps::Tiles & dstTile = world.GetTiles( dst );
+    const WorldMapSnapshot & snapshot = world.getPathfindingSnapshot();
 
-    uint32_t penalty = srcTile.isRoad() && dstTile.isRoad() ? Maps::Ground::roadPenalty : Maps::Ground::GetPenalty( srcTile, _pathfindingSkill );
+    const uint32_t srcTilePenalty = snapshot.isRoad( src ) ? Maps::Ground::roadPenalty : snapshot.getGroundPenalty( src, _pathfindingSkill );
 
-    // Diagonal movement costs 50% more
-    if ( Direction::isDiagonal( direction ) ) {
-        penalty = penalty * 3 / 2;
-    }
+    const uint32_t penalty = getBaseMovementPenalty( snapshot, src, dst, direction, _pathfindingSkill );
 
     // If we perform pathfinding for a real hero on the map, we have to work out the "last move"
     // logic: if this move is the last one on the current turn, then we can move to any adjacent
@@ -173,7 +363,6 @@ uint32_t WorldPathfinder::getMovementPenalty( int src, int dst, int direction )
         assert( src == _pathStart || node._from != -1 );
 
         const uint32_t remainingMovePoints = node._remainingMovePoints;
-        const uint32_t srcTilePenalty = srcTile.isRoad() ? Maps::Ground::roadPenalty : Maps::Ground::GetPenalty( srcTile, _pathfindingSkill );
 
         // If we still have enough movement points to move over the src tile in the straight
         // direction, but not enough to move to the dst tile, then the "last move" logic is
@@ -208,7 +397,10 @@ uint32_t WorldPathfinder::substractMovePoints( const uint32_t movePoints, const
 
 void WorldPathfinder::processWorldMap( int pathStart )
 {
-    const bool fromWater = world.GetTiles( pathStart ).isWater();
+    // The snapshot is updated by the caller: the map can be processed by several threads at once
+    const bool fromWater = world.getPathfindingSnapshot().isWater( pathStart );
+
+    onFullEvaluation();
 
     // reset cache back to default value
     for ( size_t idx = 0; idx < _cache.size(); ++idx ) {
@@ -216,18 +408,233 @@ void WorldPathfinder::processWorldMap( int pathStart )
     }
     _cache[pathStart] = WorldNode( -1, 0, MP2::MapObjectType::OBJ_ZERO, _remainingMovePoints );
 
-    std::vector<int> nodesToExplore;
-    nodesToExplore.push_back( pathStart );
+    _changedTiles.clear();
 
-    for ( size_t lastProcessedNode = 0; lastProcessedNode < nodesToExplore.size(); ++lastProcessedNode ) {
-        processCurrentNode( nodesToExplore, pathStart, nodesToExplore[lastProcessedNode], fromWater );
+    startExploration();
+    queueNode( pathStart );
+
+    for ( int currentNodeIdx = getNextNode(); currentNodeIdx != -1; currentNodeIdx = getNextNode() ) {
+        processCurrentNode( pathStart, currentNodeIdx, fromWater );
+    }
+}
+
+void WorldPathfinder::invalidateTile( const int tileIndex )
+{
+    // Nothing is cached, the whole map will be processed anyway
+    if ( _pathStart == -1 ) {
+        return;
+    }
+
+    // Too many changes, it is cheaper to process the whole map again
+    if ( _changedTiles.size() >= _cache.size() / 16 ) {
+        reset();
+        return;
+    }
+
+    _changedTiles.push_back( tileIndex );
+}
+
+void WorldPathfinder::updateWorldMap( const int pathStart, const bool isCacheReusable )
+{
+    const int previousStart = _pathStart;
+    _pathStart = pathStart;
+
+    if ( !isCacheReusable || !repairWorldMap( previousStart ) ) {
+        processWorldMap( pathStart );
+        return;
+    }
+
+#ifdef WITH_DEBUG
+    if ( IS_DEVEL() ) {
+        // Self-check: the repaired cache must be identical to the one calculated from scratch
+        const std::vector<WorldNode> repairedCache = _cache;
+        processWorldMap( pathStart );
+
+        for ( size_t idx = 0; idx < _cache.size(); ++idx ) {
+            if ( repairedCache[idx]._cost != _cache[idx]._cost || repairedCache[idx]._remainingMovePoints != _cache[idx]._remainingMovePoints ) {
+                _repairMismatches.emplace_back( static_cast<int>( idx ), repairedCache[idx] );
+            }
+        }
     }
+#endif
 }
 
-void WorldPathfinder::checkAdjacentNodes( std::vector<int> & nodesToExplore, int pathStart, int currentNodeIdx, bool fromWater )
+void WorldPathfinder::reportRepairMismatches()
+{
+#ifdef WITH_DEBUG
+    if ( _repairMismatches.empty() ) {
+        return;
+    }
+
+    for ( const std::pair<int, WorldNode> & mismatch : _repairMismatches ) {
+        const WorldNode & repairedNode = mismatch.second;
+        const WorldNode & node = _cache[mismatch.first];
+
+        DEBUG_LOG( DBG_GAME, DBG_WARN,
+                   "Repaired path differs from the full evaluation! Tile " << mismatch.first << ", cost " << repairedNode._cost << " instead of " << node._cost
+                                                                           << ", move points " << repairedNode._remainingMovePoints << " instead of "
+                                                                           << node._remainingMovePoints );
+    }
+
+    DEBUG_LOG( DBG_GAME, DBG_WARN, "Repaired paths differ from the full evaluation for " << _repairMismatches.size() << " tiles" );
+
+    const size_t differenceCount = _repairMismatches.size();
+    _repairMismatches.clear();
+
+    assert( differenceCount == 0 );
+#endif
+}
+
+bool WorldPathfinder::repairWorldMap( const int previousStart )
+{
+    enum : uint8_t
+    {
+        NODE_UNKNOWN,
+        NODE_VISITING,
+        NODE_UNREACHABLE,
+        NODE_VALID,
+        NODE_INVALID
+    };
+
+    const int pathStart = _pathStart;
+    const int mapSize = static_cast<int>( _cache.size() );
+
+    if ( previousStart < 0 || previousStart >= mapSize || pathStart < 0 || pathStart >= mapSize ) {
+        return false;
+    }
+
+    const WorldMapSnapshot & snapshot = world.getPathfindingSnapshot();
+    const bool fromWater = snapshot.isWater( pathStart );
+    if ( snapshot.isWater( previousStart ) != fromWater ) {
+        return false;
+    }
+
+    // The new start must be reachable from the previous one with the same amount of remaining movement points
+    const WorldNode & startNode = _cache[pathStart];
+    if ( ( pathStart != previousStart && startNode._from == -1 ) || startNode._remainingMovePoints != _remainingMovePoints ) {
+        return false;
+    }
+
+    std::vector<uint8_t> nodeState( _cache.size(), NODE_UNKNOWN );
+
+    // Movement from a tile depends on the tile itself and on its neighbours (corners, monster protection)
+    const Directions & directions = Direction::All();
+    for ( const int tileIndex : _changedTiles ) {
+        if ( tileIndex < 0 || tileIndex >= mapSize ) {
+            continue;
+        }
+
+        // Teleport end points depend on the state of all other teleports
+        if ( world.GetTiles( tileIndex ).GetObject( false ) == MP2::OBJ_STONELITHS ) {
+            return false;
+        }
+
+        nodeState[tileIndex] = NODE_INVALID;
+
+        for ( size_t i = 0; i < directions.size(); ++i ) {
+            if ( Maps::isValidDirection( tileIndex, directions[i] ) ) {
+                nodeState[tileIndex + _mapOffset[i]] = NODE_INVALID;
+            }
+        }
+    }
+
+    nodeState[pathStart] = NODE_VALID;
+
+    // A node stays valid only if the whole path to it goes from the new start through the unaffected nodes
+    std::vector<int> pathNodes;
+    for ( int idx = 0; idx < mapSize; ++idx ) {
+        int currentIdx = idx;
+        while ( nodeState[currentIdx] == NODE_UNKNOWN ) {
+            const int from = _cache[currentIdx]._from;
+            if ( from == -1 ) {
+                nodeState[currentIdx] = ( currentIdx == previousStart ) ? NODE_INVALID : NODE_UNREACHABLE;
+                break;
+            }
+
+            nodeState[currentIdx] = NODE_VISITING;
+            pathNodes.push_back( currentIdx );
+            currentIdx = from;
+        }
+
+        // Circular paths are never valid
+        const uint8_t state = ( nodeState[currentIdx] == NODE_VALID ) ? NODE_VALID : NODE_INVALID;
+        for ( const int nodeIdx : pathNodes ) {
+            nodeState[nodeIdx] = state;
+        }
+        pathNodes.clear();
+    }
+
+    const uint32_t startCost = startNode._cost;
+
+    for ( int idx = 0; idx < mapSize; ++idx ) {
+        if ( nodeState[idx] == NODE_INVALID ) {
+            _cache[idx].resetNode();
+        }
+        else if ( nodeState[idx] == NODE_VALID ) {
+            _cache[idx]._cost -= startCost;
+        }
+    }
+
+    _cache[pathStart] = WorldNode( -1, 0, MP2::MapObjectType::OBJ_ZERO, _remainingMovePoints );
+    _changedTiles.clear();
+
+    // Re-explore the invalidated area starting from the valid nodes around it, exactly as they were explored during the full evaluation
+    auto isExplorable = [this, &snapshot, pathStart, fromWater]( const int nodeIdx ) {
+        return nodeIdx == pathStart || snapshot.isWater( nodeIdx ) == fromWater || _cache[nodeIdx]._objectID == MP2::OBJ_STONELITHS;
+    };
+
+    std::vector<bool> isQueued( _cache.size(), false );
+    std::vector<int> seeds;
+
+    for ( int idx = 0; idx < mapSize; ++idx ) {
+        if ( nodeState[idx] != NODE_INVALID ) {
+            continue;
+        }
+
+        for ( size_t i = 0; i < directions.size(); ++i ) {
+            if ( Maps::isValidDirection( idx, directions[i] ) ) {
+                const int newIndex = idx + _mapOffset[i];
+                if ( nodeState[newIndex] == NODE_VALID && !isQueued[newIndex] && isExplorable( newIndex ) ) {
+                    isQueued[newIndex] = true;
+                    seeds.push_back( newIndex );
+                }
+            }
+        }
+
+        for ( const int teleportIdx : world.GetTeleportEndPoints( idx ) ) {
+            if ( nodeState[teleportIdx] == NODE_VALID && !isQueued[teleportIdx] && isExplorable( teleportIdx ) ) {
+                isQueued[teleportIdx] = true;
+                seeds.push_back( teleportIdx );
+            }
+        }
+    }
+
+    // The queue starts from the cheapest seed, otherwise its buckets would cover all costs from 0 to the most expensive seed
+    uint32_t minSeedCost = 0;
+    if ( !seeds.empty() ) {
+        minSeedCost = _cache[*std::min_element( seeds.begin(), seeds.end(), [this]( const int first, const int second ) {
+                                 return _cache[first]._cost < _cache[second]._cost;
+                             } )]._cost;
+    }
+
+    startExploration( minSeedCost );
+
+    for ( const int seed : seeds ) {
+        queueNode( seed );
+    }
+
+    for ( int currentNodeIdx = getNextNode(); currentNodeIdx != -1; currentNodeIdx = getNextNode() ) {
+        processCurrentNode( pathStart, currentNodeIdx, fromWater );
+    }
+
+    return true;
+}
+
+void WorldPathfinder::checkAdjacentNodes( int pathStart, int currentNodeIdx, bool fromWater )
 {
     const Directions & directions = Direction::All();
     const WorldNode & currentNode = _cache[currentNodeIdx];
+    const WorldMapSnapshot & snapshot = world.getPathfindingSnapshot();
 
     for ( size_t i = 0; i < directions.size(); ++i ) {
         if ( Maps::isValidDirection( currentNodeIdx, directions[i] ) ) {
@@ -241,17 +648,15 @@ void WorldPathfinder::checkAdjacentNodes( std::vector<int> & nodesToExplore, int
 
             WorldNode & newNode = _cache[newIndex];
 
-            if ( world.isValidPath( currentNodeIdx, directions[i], _currentColor ) && ( newNode._from == -1 || newNode._cost > moveCost ) ) {
-                const Maps::Tiles & tile = world.GetTiles( newIndex );
-
+            if ( snapshot.isValidPath( currentNodeIdx, directions[i], newIndex, _currentColor ) && ( newNode._from == -1 || newNode._cost > moveCost ) ) {
                 newNode._from = currentNodeIdx;
                 newNode._cost = moveCost;
-                newNode._objectID = tile.GetObject();
+                newNode._objectID = snapshot.getObject( newIndex );
                 newNode._remainingMovePoints = remainingMovePoints;
 
-                // duplicates are allowed if we find a cheaper way there
-                if ( tile.isWater() == fromWater )
-                    nodesToExplore.push_back( newIndex );
+                // the node is explored again if we find a cheaper way there
+                if ( snapshot.isWater( newIndex ) == fromWater )
+                    queueNode( newIndex );
             }
         }
     }
@@ -268,6 +673,8 @@ void PlayerWorldPathfinder::reset()
         _remainingMovePoints = 0;
         _maxMovePoints = 0;
     }
+
+    _changedTiles.clear();
 }
 
 void PlayerWorldPathfinder::reEvaluateIfNeeded( const Heroes & hero )
@@ -278,15 +685,17 @@ void PlayerWorldPathfinder::reEvaluateIfNeeded( const Heroes & hero )
     const uint32_t remainingMovePoints = hero.GetMovePoints();
     const uint32_t maxMovePoints = hero.GetMaxMovePoints();
 
-    if ( _pathStart != startIndex || _currentColor != color || _pathfindingSkill != skill || _remainingMovePoints != remainingMovePoints
-         || _maxMovePoints != maxMovePoints ) {
-        _pathStart = startIndex;
+    const bool isCacheReusable = _currentColor == color && _pathfindingSkill == skill && _maxMovePoints == maxMovePoints;
+
+    if ( !isCacheReusable || _pathStart != startIndex || _remainingMovePoints != remainingMovePoints || !_changedTiles.empty() ) {
         _currentColor = color;
         _pathfindingSkill = skill;
         _remainingMovePoints = remainingMovePoints;
         _maxMovePoints = maxMovePoints;
 
-        processWorldMap( startIndex );
+        world.updatePathfindingSnapshot();
+        updateWorldMap( startIndex, isCacheReusable );
+        reportRepairMismatches();
     }
 }
 
@@ -321,21 +730,29 @@ std::list<Route::Step> PlayerWorldPathfinder::buildPath( int targetIndex ) const
 }
 
 // Follows regular (for user's interface) passability rules
-void PlayerWorldPathfinder::processCurrentNode( std::vector<int> & nodesToExplore, int pathStart, int currentNodeIdx, bool fromWater )
+void PlayerWorldPathfinder::processCurrentNode( int pathStart, int currentNodeIdx, bool fromWater )
 {
     // if current tile contains a monster or a barrier, skip it
     if ( _cache[currentNodeIdx]._objectID == MP2::OBJ_MONSTER || _cache[currentNodeIdx]._objectID == MP2::OBJ_BARRIER ) {
         return;
     }
 
-    const MapsIndexes & monsters = Maps::GetTilesUnderProtection( currentNodeIdx );
+    const WorldMapSnapshot & snapshot = world.getPathfindingSnapshot();
+    const int protection = snapshot.getProtection( currentNodeIdx );
 
     // check if current tile is protected, can move only to adjacent monster
-    if ( currentNodeIdx != pathStart && !monsters.empty() ) {
-        for ( int monsterIndex : monsters ) {
-            const int direction = Maps::GetDirection( currentNodeIdx, monsterIndex );
+    if ( currentNodeIdx != pathStart && protection != Direction::UNKNOWN ) {
+        const Directions & directions = Direction::All();
+
+        for ( size_t i = 0; i < directions.size(); ++i ) {
+            const int direction = directions[i];
+            if ( ( protection & direction ) == 0 ) {
+                continue;
+            }
+
+            const int monsterIndex = currentNodeIdx + _mapOffset[i];
 
-            if ( direction != Direction::UNKNOWN && direction != Direction::CENTER && world.isValidPath( currentNodeIdx, direction, _currentColor ) ) {
+            if ( snapshot.isValidPath( currentNodeIdx, direction, monsterIndex, _currentColor ) ) {
                 // add straight to cache, can't move further from the monster
                 const uint32_t movementPenalty = getMovementPenalty( currentNodeIdx, monsterIndex, direction );
                 const uint32_t moveCost = _cache[currentNodeIdx]._cost + movementPenalty;
@@ -352,7 +769,7 @@ void PlayerWorldPathfinder::processCurrentNode( std::vector<int> & nodesToExplor
         }
     }
     else if ( currentNodeIdx == pathStart || !world.isTileBlocked( currentNodeIdx, fromWater ) ) {
-        checkAdjacentNodes( nodesToExplore, pathStart, currentNodeIdx, fromWater );
+        checkAdjacentNodes( pathStart, currentNodeIdx, fromWater );
     }
 }
 
@@ -368,9 +785,25 @@ void AIWorldPathfinder::reset()
         _remainingMovePoints = 0;
         _maxMovePoints = 0;
     }
+
+    _changedTiles.clear();
 }
 
 void AIWorldPathfinder::reEvaluateIfNeeded( const Heroes & hero )
+{
+    world.updatePathfindingSnapshot();
+    evaluateIfNeeded( hero );
+    reportRepairMismatches();
+}
+
+void AIWorldPathfinder::reEvaluateIfNeeded( int start, int color, double armyStrength, uint8_t skill )
+{
+    world.updatePathfindingSnapshot();
+    evaluateIfNeeded( start, color, armyStrength, skill );
+    reportRepairMismatches();
+}
+
+void AIWorldPathfinder::evaluateIfNeeded( const Heroes & hero )
 {
     const int startIndex = hero.GetIndex();
     const int color = hero.GetColor();
@@ -379,54 +812,59 @@ void AIWorldPathfinder::reEvaluateIfNeeded( const Heroes & hero )
     const uint32_t remainingMovePoints = hero.GetMovePoints();
     const uint32_t maxMovePoints = hero.GetMaxMovePoints();
 
-    if ( _pathStart != startIndex || _currentColor != color || std::fabs( _armyStrength - armyStrength ) > 0.001 || _pathfindingSkill != skill
-         || _remainingMovePoints != remainingMovePoints || _maxMovePoints != maxMovePoints ) {
-        _pathStart = startIndex;
+    const bool isCacheReusable = _currentColor == color && std::fabs( _armyStrength - armyStrength ) <= 0.001 && _pathfindingSkill == skill
+                                 && _maxMovePoints == maxMovePoints && !isExternalStateChanged();
+
+    if ( !isCacheReusable || _pathStart != startIndex || _remainingMovePoints != remainingMovePoints || !_changedTiles.empty() ) {
         _currentColor = color;
         _armyStrength = armyStrength;
         _pathfindingSkill = skill;
         _remainingMovePoints = remainingMovePoints;
         _maxMovePoints = maxMovePoints;
 
-        processWorldMap( startIndex );
+        updateWorldMap( startIndex, isCacheReusable );
     }
 }
 
-void AIWorldPathfinder::reEvaluateIfNeeded( int start, int color, double armyStrength, uint8_t skill )
+void AIWorldPathfinder::evaluateIfNeeded( int start, int color, double armyStrength, uint8_t skill )
 {
-    if ( _pathStart != start || _currentColor != color || std::fabs( _armyStrength - armyStrength ) > 0.001 || _pathfindingSkill != skill ) {
-        _pathStart = start;
+    const bool isCacheReusable
+        = _currentColor == color && std::fabs( _armyStrength - armyStrength ) <= 0.001 && _pathfindingSkill == skill && _maxMovePoints == 0 && !isExternalStateChanged();
+
+    if ( !isCacheReusable || _pathStart != start || !_changedTiles.empty() ) {
         _currentColor = color;
         _armyStrength = armyStrength;
         _pathfindingSkill = skill;
         _remainingMovePoints = 0;
         _maxMovePoints = 0;
 
-        processWorldMap( start );
+        // Non-hero armies do not move so the cache can be repaired only for the same start
+        updateWorldMap( start, isCacheReusable && _pathStart == start );
     }
 }
 
 // Overwrites base version in WorldPathfinder, using custom node passability rules
-void AIWorldPathfinder::processCurrentNode( std::vector<int> & nodesToExplore, int pathStart, int currentNodeIdx, bool fromWater )
+void AIWorldPathfinder::processCurrentNode( int pathStart, int currentNodeIdx, bool fromWater )
 {
     const bool isFirstNode = currentNodeIdx == pathStart;
     WorldNode & currentNode = _cache[currentNodeIdx];
 
     // find out if current node is protected by a strong army
     auto protectionCheck = [this]( const int index ) {
-        const Maps::Tiles & tile = world.GetTiles( index );
-        if ( MP2::isProtectedObject( tile.GetObject() ) ) {
-            _temporaryArmy.setFromTile( tile );
-            return _temporaryArmy.GetStrength() * _advantage > _armyStrength;
+        const WorldMapSnapshot & snapshot = world.getPathfindingSnapshot();
+        if ( MP2::isProtectedObject( snapshot.getObject( index ) ) ) {
+            return snapshot.getGuardStrength( index ) * _advantage > _armyStrength;
         }
         return false;
     };
 
     bool isProtected = protectionCheck( currentNodeIdx );
     if ( !isProtected ) {
-        const MapsIndexes & monsters = Maps::GetTilesUnderProtection( currentNodeIdx );
-        for ( auto it = monsters.begin(); it != monsters.end(); ++it ) {
-            if ( protectionCheck( *it ) ) {
+        const int protection = world.getPathfindingSnapshot().getProtection( currentNodeIdx );
+        const Directions & directions = Direction::All();
+
+        for ( size_t i = 0; i < directions.size() && protection != Direction::UNKNOWN; ++i ) {
+            if ( ( protection & directions[i] ) != 0 && protectionCheck( currentNodeIdx + _mapOffset[i] ) ) {
                 isProtected = true;
                 break;
             }
@@ -438,12 +876,12 @@ void AIWorldPathfinder::processCurrentNode( std::vector<int> & nodesToExplore, i
         currentNode.resetNode();
 
     // always allow move from the starting spot to cover edge case if got there before tile became blocked/protected
-    if ( isFirstNode || ( !isProtected && !isTileBlockedForArmy( currentNodeIdx, _currentColor, _armyStrength, fromWater ) ) ) {
+    if ( isFirstNode || ( !isProtected && !isTileBlocked( currentNodeIdx, fromWater ) ) ) {
         const MapsIndexes & teleporters = world.GetTeleportEndPoints( currentNodeIdx );
 
         // do not check adjacent if we're going through the teleport in the middle of the path
         if ( isFirstNode || teleporters.empty() || std::find( teleporters.begin(), teleporters.end(), currentNode._from ) != teleporters.end() ) {
-            checkAdjacentNodes( nodesToExplore, pathStart, currentNodeIdx, fromWater );
+            checkAdjacentNodes( pathStart, currentNodeIdx, fromWater );
         }
 
         // special case: move through teleporters
@@ -460,12 +898,45 @@ void AIWorldPathfinder::processCurrentNode( std::vector<int> & nodesToExplore, i
                 teleportNode._objectID = MP2::OBJ_STONELITHS;
                 teleportNode._remainingMovePoints = currentNode._remainingMovePoints;
 
-                nodesToExplore.push_back( teleportIdx );
+                queueNode( teleportIdx );
             }
         }
     }
 }
 
+void AIWorldPathfinder::onFullEvaluation()
+{
+    _externalBlockingStates.clear();
+}
+
+bool AIWorldPathfinder::isTileBlocked( const int tileIndex, const bool fromWater )
+{
+    const bool isBlocked = isTileBlockedForArmy( tileIndex, _currentColor, _armyStrength, fromWater );
+
+    const MP2::MapObjectType objectType = world.getPathfindingSnapshot().getObject( tileIndex );
+    if ( objectType == MP2::OBJ_HEROES || objectType == MP2::OBJ_BARRIER ) {
+        _externalBlockingStates[tileIndex] = isBlocked;
+    }
+
+    return isBlocked;
+}
+
+bool AIWorldPathfinder::isExternalStateChanged() const
+{
+    if ( _pathStart == -1 ) {
+        return false;
+    }
+
+    // The result for heroes and barriers does not depend on the water
+    for ( const std::pair<const int, bool> & state : _externalBlockingStates ) {
+        if ( isTileBlockedForArmy( state.first, _currentColor, _armyStrength, false ) != state.second ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 int AIWorldPathfinder::getFogDiscoveryTile( const Heroes & hero )
 {
     // paths have to be pre-calculated to find a spot where we're able to move
@@ -513,8 +984,7 @@ int AIWorldPathfinder::getFogDiscoveryTile( const Heroes & hero )
                         continue;
                     }
 
-                    const MapsIndexes & monsters = Maps::GetTilesUnderProtection( newIndex );
-                    if ( _cache[newIndex]._cost && monsters.empty() )
+                    if ( _cache[newIndex]._cost && world.getTileProtection( newIndex ) == Direction::UNKNOWN )
                         nodesToExplore.push_back( newIndex );
                 }
             }
@@ -544,8 +1014,7 @@ int AIWorldPathfinder::getNeareastTileToMove( const Heroes & hero )
                 continue;
             }
 
-            const MapsIndexes & monsters = Maps::GetTilesUnderProtection( newIndex );
-            if ( _cache[newIndex]._cost && monsters.empty() ) {
+            if ( _cache[newIndex]._cost && world.getTileProtection( newIndex ) == Direction::UNKNOWN ) {
                 return newIndex;
             }
         }
@@ -681,3 +1150,623 @@ void AIWorldPathfinder::setArmyStrengthMultplier( const double multiplier )
         reset();
     }
 }
+
+void RegionPathfinder::reset()
+{
+    _isBuildNeeded = true;
+}
+
+void RegionPathfinder::invalidateTile( const int32_t tileIndex )
+{
+    if ( _isBuildNeeded || tileIndex < 0 || static_cast<size_t>( tileIndex ) >= _tileRegions.size() ) {
+        return;
+    }
+
+    // Passability of the tile affects its neighbours which can belong to other regions
+    _regions[_tileRegions[tileIndex]].isOutdated = true;
+
+    for ( const int direction : Direction::All() ) {
+        if ( Maps::isValidDirection( tileIndex, direction ) ) {
+            _regions[_tileRegions[Maps::GetDirectionIndex( tileIndex, direction )]].isOutdated = true;
+        }
+    }
+}
+
+uint32_t RegionPathfinder::getDistance( const int32_t start, const int32_t target )
+{
+    std::vector<Exit> nodePath;
+    uint32_t cost = 0;
+
+    if ( !findNodePath( start, target, nodePath, cost ) ) {
+        return 0;
+    }
+
+    return cost;
+}
+
+std::list<Route::Step> RegionPathfinder::buildPath( const int32_t start, const int32_t target )
+{
+    std::list<Route::Step> path;
+
+    std::vector<Exit> nodePath;
+    uint32_t cost = 0;
+
+    if ( !findNodePath( start, target, nodePath, cost ) ) {
+        return path;
+    }
+
+    const WorldMapSnapshot & snapshot = world.getPathfindingSnapshot();
+
+    int32_t current = start;
+    for ( const Exit & step : nodePath ) {
+        const int32_t nodeIndex = _nodes[step.node].index;
+
+        if ( step.direction == Direction::CENTER ) {
+            appendRegionPath( path, current, nodeIndex );
+        }
+        else if ( step.direction == Direction::UNKNOWN ) {
+            path.emplace_back( nodeIndex, current, Maps::GetDirection( current, nodeIndex ), 0 );
+        }
+        else {
+            path.emplace_back( nodeIndex, current, step.direction, getBaseMovementPenalty( snapshot, current, nodeIndex, step.direction, regionGraphPathfindingSkill ) );
+        }
+
+        current = nodeIndex;
+    }
+
+    appendRegionPath( path, current, target );
+
+    return path;
+}
+
+void RegionPathfinder::build()
+{
+    const int32_t worldSize = static_cast<int32_t>( world.getSize() );
+    const uint32_t regionCount = static_cast<uint32_t>( world.getRegionCount() );
+
+    _tileRegions.resize( worldSize );
+    for ( int32_t idx = 0; idx < worldSize; ++idx ) {
+        const uint32_t regionId = world.GetTiles( idx ).GetRegion();
+        _tileRegions[idx] = regionId < regionCount ? regionId : static_cast<uint32_t>( REGION_NODE_BLOCKED );
+    }
+
+    // Base region IDs are always present even if the regions have not been computed yet
+    _regions.clear();
+    _regions.resize( std::max( regionCount, static_cast<uint32_t>( REGION_NODE_FOUND ) ) );
+    _nodes.clear();
+    _tileNodes.assign( worldSize, -1 );
+
+    _tileCosts.assign( worldSize, 0 );
+    _tileFrom.assign( worldSize, -1 );
+    _exploredTiles.clear();
+
+    world.updatePathfindingSnapshot();
+    const WorldMapSnapshot & snapshot = world.getPathfindingSnapshot();
+
+    // Tiles from which it is possible to move to an adjacent region, the key is the pair of regions. Tiles are sorted by index.
+    std::map<std::pair<uint32_t, uint32_t>, std::vector<int32_t>> borders;
+
+    for ( int32_t idx = 0; idx < worldSize; ++idx ) {
+        const uint32_t regionId = _tileRegions[idx];
+        if ( regionId < REGION_NODE_FOUND ) {
+            continue;
+        }
+
+        for ( const int direction : Direction::All() ) {
+            if ( !Maps::isValidDirection( idx, direction ) ) {
+                continue;
+            }
+
+            const int32_t adjacentIndex = Maps::GetDirectionIndex( idx, direction );
+            const uint32_t adjacentRegionId = _tileRegions[adjacentIndex];
+            if ( adjacentRegionId == regionId || adjacentRegionId < REGION_NODE_FOUND || !snapshot.isValidPathIgnoringFog( idx, direction ) ) {
+                continue;
+            }
+
+            std::vector<int32_t> & borderTiles = borders[std::make_pair( regionId, adjacentRegionId )];
+            if ( borderTiles.empty() || borderTiles.back() != idx ) {
+                borderTiles.push_back( idx );
+            }
+        }
+    }
+
+    // Every continuous segment of the border gets a single entrance in its middle
+    for ( const auto & border : borders ) {
+        const std::vector<int32_t> & borderTiles = border.second;
+        std::vector<bool> isVisited( borderTiles.size(), false );
+
+        for ( size_t first = 0; first < borderTiles.size(); ++first ) {
+            if ( isVisited[first] ) {
+                continue;
+            }
+
+            std::vector<int32_t> segment( 1, borderTiles[first] );
+            isVisited[first] = true;
+
+            for ( size_t current = 0; current < segment.size(); ++current ) {
+                for ( const int direction : Direction::All() ) {
+                    if ( !Maps::isValidDirection( segment[current], direction ) ) {
+                        continue;
+                    }
+
+                    const int32_t adjacentIndex = Maps::GetDirectionIndex( segment[current], direction );
+                    const auto it = std::lower_bound( borderTiles.begin(), borderTiles.end(), adjacentIndex );
+                    if ( it != borderTiles.end() && *it == adjacentIndex && !isVisited[it - borderTiles.begin()] ) {
+                        isVisited[it - borderTiles.begin()] = true;
+                        segment.push_back( *it );
+                    }
+                }
+            }
+
+            const int32_t entrance = segment[segment.size() / 2];
+
+            for ( const int direction : Direction::All() ) {
+                if ( !Maps::isValidDirection( entrance, direction ) ) {
+                    continue;
+                }
+
+                const int32_t exitIndex = Maps::GetDirectionIndex( entrance, direction );
+                if ( _tileRegions[exitIndex] == border.first.second && snapshot.isValidPathIgnoringFog( entrance, direction ) ) {
+                    const size_t entranceNode = addNode( entrance );
+                    const size_t exitNode = addNode( exitIndex );
+                    _nodes[entranceNode].exits.push_back( { exitNode, direction } );
+                    break;
+                }
+            }
+        }
+    }
+
+    // Teleporters connect regions as well
+    for ( int32_t idx = 0; idx < worldSize; ++idx ) {
+        if ( _tileRegions[idx] < REGION_NODE_FOUND || snapshot.getObject( idx ) != MP2::OBJ_STONELITHS ) {
+            continue;
+        }
+
+        for ( const int32_t exitIndex : world.GetTeleportEndPoints( idx ) ) {
+            if ( _tileRegions[exitIndex] < REGION_NODE_FOUND ) {
+                continue;
+            }
+
+            const size_t entranceNode = addNode( idx );
+            const size_t exitNode = addNode( exitIndex );
+            _nodes[entranceNode].exits.push_back( { exitNode, Direction::UNKNOWN } );
+        }
+    }
+
+    _isBuildNeeded = false;
+}
+
+void RegionPathfinder::update()
+{
+    if ( _isBuildNeeded || _tileRegions.size() != world.getSize() ) {
+        build();
+    }
+
+    world.updatePathfindingSnapshot();
+
+    for ( RegionData & region : _regions ) {
+        if ( region.isOutdated ) {
+            updateRegion( region );
+        }
+    }
+}
+
+size_t RegionPathfinder::addNode( const int32_t index )
+{
+    if ( _tileNodes[index] != -1 ) {
+        return static_cast<size_t>( _tileNodes[index] );
+    }
+
+    const size_t nodeId = _nodes.size();
+    RegionData & region = _regions[_tileRegions[index]];
+
+    _nodes.emplace_back();
+
+    Node & node = _nodes.back();
+    node.index = index;
+    node.region = _tileRegions[index];
+    node.localId = region.nodes.size();
+
+    region.nodes.push_back( nodeId );
+    _tileNodes[index] = static_cast<int32_t>( nodeId );
+
+    return nodeId;
+}
+
+void RegionPathfinder::updateRegion( RegionData & region )
+{
+    const size_t nodeCount = region.nodes.size();
+    region.costs.assign( nodeCount * nodeCount, 0 );
+
+    for ( size_t from = 0; from < nodeCount; ++from ) {
+        const int32_t fromIndex = _nodes[region.nodes[from]].index;
+
+        // It is possible to stop at the object but not to pass through it
+        if ( isTileBlocked( fromIndex ) ) {
+            continue;
+        }
+
+        exploreRegion( fromIndex );
+
+        for ( size_t to = 0; to < nodeCount; ++to ) {
+            if ( to != from ) {
+                region.costs[from * nodeCount + to] = _tileCosts[_nodes[region.nodes[to]].index];
+            }
+        }
+    }
+
+    region.isOutdated = false;
+}
+
+void RegionPathfinder::exploreRegion( const int32_t start )
+{
+    for ( const int32_t idx : _exploredTiles ) {
+        _tileCosts[idx] = 0;
+        _tileFrom[idx] = -1;
+    }
+
+    _exploredTiles.clear();
+    _tilesToExplore.clear();
+
+    const WorldMapSnapshot & snapshot = world.getPathfindingSnapshot();
+    const uint32_t regionId = _tileRegions[start];
+
+    _exploredTiles.push_back( start );
+    _tilesToExplore.push( start, 0 );
+
+    while ( !_tilesToExplore.empty() ) {
+        uint32_t cost = 0;
+        const int32_t current = _tilesToExplore.pop( cost );
+
+        // Skip outdated entries and objects, the start is always left
+        if ( cost != _tileCosts[current] || ( current != start && isTileBlocked( current ) ) ) {
+            continue;
+        }
+
+        for ( const int direction : Direction::All() ) {
+            if ( !Maps::isValidDirection( current, direction ) ) {
+                continue;
+            }
+
+            const int32_t next = Maps::GetDirectionIndex( current, direction );
+            if ( next == start || _tileRegions[next] != regionId || !snapshot.isValidPathIgnoringFog( current, direction ) ) {
+                continue;
+            }
+
+            const uint32_t nextCost = cost + getBaseMovementPenalty( snapshot, current, next, direction, regionGraphPathfindingSkill );
+
+            if ( _tileFrom[next] == -1 || _tileCosts[next] > nextCost ) {
+                if ( _tileFrom[next] == -1 ) {
+                    _exploredTiles.push_back( next );
+                }
+
+                _tileFrom[next] = current;
+                _tileCosts[next] = nextCost;
+                _tilesToExplore.push( next, nextCost );
+            }
+        }
+    }
+}
+
+bool RegionPathfinder::isTileBlocked( const int32_t index ) const
+{
+    const WorldMapSnapshot & snapshot = world.getPathfindingSnapshot();
+    const MP2::MapObjectType objectType = snapshot.getObject( index );
+
+    // Armies might be defeated so the graph does not depend on their strength
+    if ( objectType == MP2::OBJ_HEROES || objectType == MP2::OBJ_MONSTER ) {
+        return false;
+    }
+
+    return objectType == MP2::OBJ_BOAT || MP2::isPickupObject( objectType ) || MP2::isActionObject( objectType, snapshot.isWater( index ) );
+}
+
+bool RegionPathfinder::findNodePath( const int32_t start, const int32_t target, std::vector<Exit> & nodePath, uint32_t & cost )
+{
+    nodePath.clear();
+    cost = 0;
+
+    const int32_t worldSize = static_cast<int32_t>( world.getSize() );
+    if ( start < 0 || start >= worldSize || target < 0 || target >= worldSize || start == target ) {
+        return false;
+    }
+
+    update();
+
+    const WorldMapSnapshot & snapshot = world.getPathfindingSnapshot();
+    const uint32_t targetRegionId = _tileRegions[target];
+
+    // The target in the same region might be reachable directly
+    exploreRegion( start );
+
+    uint32_t bestCost = ( _tileRegions[start] == targetRegionId && _tileFrom[target] != -1 ) ? _tileCosts[target] : 0;
+    int32_t bestNode = -1;
+
+    const uint32_t unreachableCost = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> nodeCosts( _nodes.size(), unreachableCost );
+    std::vector<Exit> nodeFrom( _nodes.size(), Exit{ 0, Direction::CENTER } );
+
+    using QueueItem = std::pair<uint32_t, size_t>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> nodesToExplore;
+
+    auto relaxNode = [&nodeCosts, &nodeFrom, &nodesToExplore]( const size_t nodeId, const uint32_t nodeCost, const Exit & from ) {
+        if ( nodeCost < nodeCosts[nodeId] ) {
+            nodeCosts[nodeId] = nodeCost;
+            nodeFrom[nodeId] = from;
+            nodesToExplore.emplace( nodeCost, nodeId );
+        }
+    };
+
+    // Nodes of the start region are reached directly, they have no previous node
+    const size_t noNode = _nodes.size();
+
+    for ( const size_t nodeId : _regions[_tileRegions[start]].nodes ) {
+        const int32_t nodeIndex = _nodes[nodeId].index;
+        if ( nodeIndex == start ) {
+            relaxNode( nodeId, 0, Exit{ noNode, Direction::CENTER } );
+        }
+        else if ( _tileFrom[nodeIndex] != -1 ) {
+            relaxNode( nodeId, _tileCosts[nodeIndex], Exit{ noNode, Direction::CENTER } );
+        }
+    }
+
+    while ( !nodesToExplore.empty() ) {
+        const QueueItem item = nodesToExplore.top();
+        nodesToExplore.pop();
+
+        const uint32_t nodeCost = item.first;
+        const size_t nodeId = item.second;
+
+        if ( nodeCost != nodeCosts[nodeId] ) {
+            continue;
+        }
+
+        if ( bestCost != 0 && nodeCost >= bestCost ) {
+            break;
+        }
+
+        const Node & node = _nodes[nodeId];
+
+        if ( node.region == targetRegionId ) {
+            uint32_t targetCost = 0;
+            if ( node.index == target ) {
+                targetCost = nodeCost;
+            }
+            else if ( !isTileBlocked( node.index ) ) {
+                exploreRegion( node.index );
+                if ( _tileFrom[target] != -1 ) {
+                    targetCost = nodeCost + _tileCosts[target];
+                }
+            }
+
+            if ( targetCost != 0 && ( bestCost == 0 || targetCost < bestCost ) ) {
+                bestCost = targetCost;
+                bestNode = static_cast<int32_t>( nodeId );
+            }
+        }
+
+        if ( node.index != start && isTileBlocked( node.index ) ) {
+            continue;
+        }
+
+        const RegionData & region = _regions[node.region];
+        const size_t nodeCount = region.nodes.size();
+
+        for ( size_t to = 0; to < nodeCount; ++to ) {
+            const uint32_t regionCost = region.costs[node.localId * nodeCount + to];
+            if ( regionCost != 0 ) {
+                relaxNode( region.nodes[to], nodeCost + regionCost, Exit{ nodeId, Direction::CENTER } );
+            }
+        }
+
+        for ( const Exit & exit : node.exits ) {
+            const int32_t exitIndex = _nodes[exit.node].index;
+
+            if ( exit.direction == Direction::UNKNOWN ) {
+                relaxNode( exit.node, nodeCost, Exit{ nodeId, Direction::UNKNOWN } );
+            }
+            else if ( snapshot.isValidPathIgnoringFog( node.index, exit.direction ) ) {
+                const uint32_t exitCost = getBaseMovementPenalty( snapshot, node.index, exitIndex, exit.direction, regionGraphPathfindingSkill );
+                relaxNode( exit.node, nodeCost + exitCost, Exit{ nodeId, exit.direction } );
+            }
+        }
+    }
+
+    if ( bestCost == 0 ) {
+        return false;
+    }
+
+    // Each element of the path is the node and the way it has been reached
+    size_t nodeId = static_cast<size_t>( bestNode );
+    if ( bestNode != -1 ) {
+        while ( nodeId != noNode ) {
+            nodePath.push_back( Exit{ nodeId, nodeFrom[nodeId].direction } );
+            nodeId = nodeFrom[nodeId].node;
+        }
+    }
+
+    std::reverse( nodePath.begin(), nodePath.end() );
+
+    cost = bestCost;
+    return true;
+}
+
+void RegionPathfinder::appendRegionPath( std::list<Route::Step> & path, const int32_t start, const int32_t target )
+{
+    if ( start == target ) {
+        return;
+    }
+
+    exploreRegion( start );
+
+    if ( _tileFrom[target] == -1 ) {
+        return;
+    }
+
+    std::list<Route::Step> regionPath;
+
+    for ( int32_t current = target; current != start; current = _tileFrom[current] ) {
+        const int32_t from = _tileFrom[current];
+        regionPath.emplace_front( current, from, Maps::GetDirection( from, current ), _tileCosts[current] - _tileCosts[from] );
+    }
+
+    path.splice( path.end(), regionPath );
+}
+
+AIWorldPathfinder & AIHeroPathfinders::get( const Heroes & hero )
+{
+    std::unique_ptr<AIWorldPathfinder> & pathfinder = _pathfinders[hero.GetID()];
+    if ( !pathfinder ) {
+        pathfinder.reset( new AIWorldPathfinder( _advantage ) );
+        pathfinder->reset();
+    }
+
+    return *pathfinder;
+}
+
+void AIHeroPathfinders::reEvaluateIfNeeded( const std::vector<const Heroes *> & heroes )
+{
+    // Dead or dismissed heroes do not need their caches anymore. Heroes of other kingdoms keep theirs for the next turn.
+    for ( auto iter = _pathfinders.begin(); iter != _pathfinders.end(); ) {
+        const Heroes * hero = world.GetHeroes( iter->first );
+        if ( hero == nullptr || !hero->isValid() || hero->isFreeman() ) {
+            iter = _pathfinders.erase( iter );
+        }
+        else {
+            ++iter;
+        }
+    }
+
+    std::vector<AIWorldPathfinder *> pathfinders;
+    pathfinders.reserve( heroes.size() );
+
+    for ( const Heroes * hero : heroes ) {
+        pathfinders.push_back( &get( *hero ) );
+    }
+
+    // Every pathfinder reads the snapshot while the world is not modified so it must be up to date before the threads start.
+    // The result of each pathfinder depends only on its hero so the order of evaluation does not affect AI decisions.
+    world.updatePathfindingSnapshot();
+
+    fheroes2::getThreadPool().parallelFor( heroes.size(), [&heroes, &pathfinders]( const size_t idx ) {
+        pathfinders[idx]->evaluateIfNeeded( *heroes[idx] );
+    } );
+
+    for ( AIWorldPathfinder * pathfinder : pathfinders ) {
+        pathfinder->reportRepairMismatches();
+    }
+}
+
+void AIHeroPathfinders::reset()
+{
+    for ( auto & pathfinder : _pathfinders ) {
+        pathfinder.second->reset();
+    }
+}
+
+void AIHeroPathfinders::invalidateTile( const int tileIndex )
+{
+    for ( auto & pathfinder : _pathfinders ) {
+        pathfinder.second->invalidateTile( tileIndex );
+    }
+}
+
+void AIHeroPathfinders::setArmyStrengthMultplier( const double multiplier )
+{
+    if ( multiplier > 0 && std::fabs( _advantage - multiplier ) > 0.001 ) {
+        _advantage = multiplier;
+
+        for ( auto & pathfinder : _pathfinders ) {
+            pathfinder.second->setArmyStrengthMultplier( multiplier );
+        }
+    }
+}
+
+std::vector<uint32_t> AIDistanceMatrix::calculate( const std::vector<std::pair<int, double>> & armies, const std::vector<int> & targets,
+                                                   const std::vector<bool> & requiredPairs, const int color )
+{
+    const size_t targetCount = targets.size();
+    std::vector<uint32_t> distances( armies.size() * targetCount, 0 );
+
+    assert( requiredPairs.size() == distances.size() );
+
+    // Armies located on the same tile share the pathfinder so they are evaluated one by one by the same task
+    std::map<int, std::vector<size_t>> armiesPerTile;
+    for ( size_t army = 0; army < armies.size(); ++army ) {
+        for ( size_t target = 0; target < targetCount; ++target ) {
+            if ( requiredPairs[army * targetCount + target] ) {
+                armiesPerTile[armies[army].first].push_back( army );
+                break;
+            }
+        }
+    }
+
+    // Pathfinders of the armies of this color which are not on the map anymore are not needed
+    for ( auto iter = _pathfinders.begin(); iter != _pathfinders.end(); ) {
+        if ( iter->first.first == color && armiesPerTile.count( iter->first.second ) == 0 ) {
+            iter = _pathfinders.erase( iter );
+        }
+        else {
+            ++iter;
+        }
+    }
+
+    if ( armiesPerTile.empty() ) {
+        return distances;
+    }
+
+    std::vector<AIWorldPathfinder *> pathfinders;
+    std::vector<const std::vector<size_t> *> tasks;
+    pathfinders.reserve( armiesPerTile.size() );
+    tasks.reserve( armiesPerTile.size() );
+
+    for ( const auto & tileArmies : armiesPerTile ) {
+        std::unique_ptr<AIWorldPathfinder> & pathfinder = _pathfinders[std::make_pair( color, tileArmies.first )];
+        if ( !pathfinder ) {
+            pathfinder.reset( new AIWorldPathfinder( _advantage ) );
+            pathfinder->reset();
+        }
+
+        pathfinders.push_back( pathfinder.get() );
+        tasks.push_back( &tileArmies.second );
+    }
+
+    // The snapshot must be up to date before the threads start, see AIHeroPathfinders::reEvaluateIfNeeded()
+    world.updatePathfindingSnapshot();
+
+    fheroes2::getThreadPool().parallelFor( tasks.size(), [&armies, &targets, &requiredPairs, &distances, &pathfinders, &tasks, targetCount,
+                                                          color]( const size_t taskId ) {
+        AIWorldPathfinder & pathfinder = *pathfinders[taskId];
+
+        for ( const size_t army : *tasks[taskId] ) {
+            for ( size_t target = 0; target < targetCount; ++target ) {
+                const size_t pairId = army * targetCount + target;
+                if ( requiredPairs[pairId] ) {
+                    // The map is evaluated only for the first target of the army
+                    pathfinder.evaluateIfNeeded( armies[army].first, color, armies[army].second, Skill::Level::EXPERT );
+                    distances[pairId] = pathfinder.getDistance( targets[target] );
+                }
+            }
+        }
+    } );
+
+    for ( AIWorldPathfinder * pathfinder : pathfinders ) {
+        pathfinder->reportRepairMismatches();
+    }
+
+    return distances;
+}
+
+void AIDistanceMatrix::reset()
+{
+    for ( auto & pathfinder : _pathfinders ) {
+        pathfinder.second->reset();
+    }
+}
+
+void AIDistanceMatrix::invalidateTile( const int tileIndex )
+{
+    for ( auto & pathfinder : _pathfinders ) {
+        pathfinder.second->invalidateTile( tileIndex );
+    }
+}
@@ -20,6 +20,10 @@
 
 #pragma once
 
+#include <array>
+#include <map>
+#include <memory>
+
 #include "army.h"
 #include "color.h"
 #include "mp2.h"
@@ -28,6 +32,104 @@
 
 class IndexObject;
 
+// Compact copy of the tile data used by the world map pathfinders. The data is stored as separate arrays to avoid
+// walking the Maps::Tiles objects (and their addons) for every explored edge. Modified tiles have to be invalidated.
+class WorldMapSnapshot
+{
+public:
+    // Marks the whole snapshot as outdated, it is re-created on the next update() call
+    void reset();
+
+    // Marks the tile as outdated. Passability of its neighbours is updated as well.
+    void invalidate( const int32_t tileIndex );
+
+    // Updates all outdated tiles
+    void update();
+
+    // Checks the movement from the tile to the adjacent tile in the given direction, the same as World::isValidPath()
+    bool isValidPath( const int32_t index, const int direction, const int32_t toIndex, const int heroColor ) const
+    {
+        return ( _passableDirections[index] & direction ) != 0 && ( _fogColors[index] & heroColor ) != heroColor && ( _fogColors[toIndex] & heroColor ) != heroColor;
+    }
+
+    // Checks the movement from the tile to the adjacent tile in the given direction without taking the fog into account
+    bool isValidPathIgnoringFog( const int32_t index, const int direction ) const
+    {
+        return ( _passableDirections[index] & direction ) != 0;
+    }
+
+    uint32_t getGroundPenalty( const int32_t index, const uint8_t pathfindingSkill ) const
+    {
+        return _groundPenalty[pathfindingSkill][index];
+    }
+
+    bool isWater( const int32_t index ) const
+    {
+        return ( _flags[index] & TILE_WATER ) != 0;
+    }
+
+    bool isRoad( const int32_t index ) const
+    {
+        return ( _flags[index] & TILE_ROAD ) != 0;
+    }
+
+    MP2::MapObjectType getObject( const int32_t index ) const
+    {
+        return static_cast<MP2::MapObjectType>( _objectTypes[index] );
+    }
+
+    // See Maps::calculateTileProtection()
+    int getProtection( const int32_t index ) const
+    {
+        return _protection[index];
+    }
+
+    // Strength of the army guarding the object on the tile, the same as Army( tile ).GetStrength(). It can be called from any thread.
+    double getGuardStrength( const int32_t index ) const;
+
+private:
+    enum : uint8_t
+    {
+        TILE_WATER = 0x01,
+        TILE_ROAD = 0x02
+    };
+
+    void updateTile( const int32_t index );
+    void updatePassability( const int32_t index );
+    void updateProtection( const int32_t index );
+    void updateGuard( const int32_t index );
+
+    // Army guarding a protected object. The tile data it is built from is kept to detect tiles changed without invalidation.
+    struct TileGuard
+    {
+        bool isUpToDate( const Maps::Tiles & tile ) const;
+
+        double strength = 0;
+        uint32_t monsterCount = 0;
+        int monsterId = Monster::UNKNOWN;
+        uint8_t object = MP2::OBJ_ZERO;
+        uint8_t objectUnderHero = MP2::OBJ_ZERO;
+        uint8_t quantity1 = 0;
+        uint8_t quantity2 = 0;
+    };
+
+    // Directions (Direction::TOP_LEFT ... Direction::LEFT bits) to which movement is possible without taking the fog into account
+    std::vector<uint8_t> _passableDirections;
+    std::vector<uint8_t> _fogColors;
+    std::vector<uint8_t> _flags;
+    std::vector<uint8_t> _objectTypes;
+    // Directions of the attacking monsters, they depend on the neighbours as well
+    std::vector<uint16_t> _protection;
+    // Ground penalty for each pathfinding skill level
+    std::array<std::vector<uint16_t>, Skill::Level::EXPERT + 1> _groundPenalty;
+    std::vector<TileGuard> _guards;
+    // Reused to build the guards without allocations
+    Army _guardArmy;
+
+    std::vector<int32_t> _outdatedTiles;
+    bool _isFullUpdateNeeded = true;
+};
+
 struct WorldNode : public PathfindingNode<MP2::MapObjectType>
 {
     uint32_t _remainingMovePoints = 0;
@@ -56,12 +158,33 @@ public:
     // This method resizes the cache and re-calculates map offsets if values are out of sync with World class
     virtual void checkWorldSize();
 
+    // Marks the tile as modified (object, passability or fog has been changed). The cached paths affected by this tile
+    // will be repaired during the next re-evaluation instead of processing the whole map again.
+    void invalidateTile( const int tileIndex );
+
 protected:
     void processWorldMap( int pathStart );
-    void checkAdjacentNodes( std::vector<int> & nodesToExplore, int pathStart, int currentNodeIdx, bool fromWater );
+
+    // Sets the new path start and re-evaluates the paths. If the cache is reusable (all other pathfinding parameters are
+    // the same) then only the paths affected by the invalidated tiles are re-evaluated, otherwise the whole map is processed.
+    void updateWorldMap( const int pathStart, const bool isCacheReusable );
+
+    // Repairs the cached paths calculated from the previous start. The new start has to be either the same or located on
+    // one of the cached paths (the hero moved along the path) with the same amount of remaining movement points.
+    // Returns false if the cache cannot be repaired and the whole map has to be processed.
+    bool repairWorldMap( const int previousStart );
+
+    // Reports the differences found by the self-check of the repaired paths in debug builds. The check can run in a worker
+    // thread so the differences are kept and reported later by the thread which requested the re-evaluation.
+    void reportRepairMismatches();
+
+    void checkAdjacentNodes( int pathStart, int currentNodeIdx, bool fromWater );
 
     // This method defines pathfinding rules. This has to be implemented by the derived class.
-    virtual void processCurrentNode( std::vector<int> & nodesToExplore, int pathStart, int currentNodeIdx, bool fromWater ) = 0;
+    virtual void processCurrentNode( int pathStart, int currentNodeIdx, bool fromWater ) = 0;
+
+    // Called before the whole map is processed from scratch
+    virtual void onFullEvaluation() {}
 
     // Calculates the movement penalty when moving from the src tile to the adjacent dst tile in the specified direction.
     // If the "last move" logic should be taken into account (when performing pathfinding for a real hero on the map),
@@ -77,6 +200,12 @@ protected:
     uint32_t _remainingMovePoints = 0;
     uint32_t _maxMovePoints = 0;
     std::vector<int> _mapOffset;
+    std::vector<int> _changedTiles;
+
+#ifdef WITH_DEBUG
+    // Tile indexes and repaired nodes which differ from the full evaluation
+    std::vector<std::pair<int, WorldNode>> _repairMismatches;
+#endif
 };
 
 class PlayerWorldPathfinder : public WorldPathfinder
@@ -90,7 +219,7 @@ public:
     std::list<Route::Step> buildPath( int targetIndex ) const;
 
 private:
-    void processCurrentNode( std::vector<int> & nodesToExplore, int pathStart, int currentNodeIdx, bool fromWater ) override;
+    void processCurrentNode( int pathStart, int currentNodeIdx, bool fromWater ) override;
 };
 
 class AIWorldPathfinder : public WorldPathfinder
@@ -130,9 +259,155 @@ public:
     void setArmyStrengthMultplier( const double multiplier );
 
 private:
-    void processCurrentNode( std::vector<int> & nodesToExplore, int pathStart, int currentNodeIdx, bool fromWater ) override;
+    friend class AIHeroPathfinders;
+    friend class AIDistanceMatrix;
+
+    // Same as reEvaluateIfNeeded() but neither updates the snapshot nor writes logs so it is safe to call from worker threads
+    void evaluateIfNeeded( int start, int color, double armyStrength, uint8_t skill );
+    void evaluateIfNeeded( const Heroes & hero );
 
+    void processCurrentNode( int pathStart, int currentNodeIdx, bool fromWater ) override;
+    void onFullEvaluation() override;
+
+    // Heroes and barriers block the way depending on the data which does not invalidate tiles (armies of other heroes, keys
+    // of the kingdom). Their results are kept and the cache is reused only if all of them are the same.
+    bool isTileBlocked( const int tileIndex, const bool fromWater );
+    bool isExternalStateChanged() const;
+
+    std::map<int, bool> _externalBlockingStates;
     double _armyStrength = -1;
     double _advantage = 1.0;
-    Army _temporaryArmy; // for internal calculations
+};
+
+// Abstract graph built on top of the map regions (see World::ComputeStaticAnalysis) for fast distance estimation, similar
+// to HPA*. Every border segment between two adjacent regions has an entrance, the costs between entrances of the same region
+// are pre-calculated and only the regions of the start and the target are explored for every query. Armies and fog are not
+// taken into account so the results are approximate.
+class RegionPathfinder
+{
+public:
+    // The graph is re-built on the next query
+    void reset();
+
+    // Marks the regions of the tile and its neighbours as modified, their costs are re-calculated on the next query
+    void invalidateTile( const int32_t tileIndex );
+
+    // Returns the approximate movement cost from the start to the target or 0 if no path is found. The path goes through a single
+    // entrance per border segment so the cost can be bigger than the real one. Keys and armies are not taken into account so 0
+    // does not prove that the target cannot be reached.
+    uint32_t getDistance( const int32_t start, const int32_t target );
+
+    // Returns the path along the region graph, the part of the path inside every region is the shortest one
+    std::list<Route::Step> buildPath( const int32_t start, const int32_t target );
+
+private:
+    struct Exit
+    {
+        size_t node;
+        // Direction::UNKNOWN for teleporters
+        int direction;
+    };
+
+    struct Node
+    {
+        int32_t index;
+        uint32_t region;
+        // Index of the node within RegionData::nodes
+        size_t localId;
+        std::vector<Exit> exits;
+    };
+
+    struct RegionData
+    {
+        std::vector<size_t> nodes;
+        // Costs between all pairs of the region nodes (row is the source), 0 means unreachable
+        std::vector<uint32_t> costs;
+        bool isOutdated = true;
+    };
+
+    void build();
+    void update();
+    size_t addNode( const int32_t index );
+    void updateRegion( RegionData & region );
+
+    // Finds the shortest paths from the tile to all tiles of the same region
+    void exploreRegion( const int32_t start );
+
+    bool isTileBlocked( const int32_t index ) const;
+
+    // Finds the cheapest sequence of nodes from the start to the target, the direction of every element describes how the node
+    // is reached (Direction::CENTER - inside the region). Returns false if the target cannot be reached.
+    bool findNodePath( const int32_t start, const int32_t target, std::vector<Exit> & nodePath, uint32_t & cost );
+
+    // Appends the shortest path between two tiles of the same region
+    void appendRegionPath( std::list<Route::Step> & path, const int32_t start, const int32_t target );
+
+    std::vector<uint32_t> _tileRegions;
+    std::vector<RegionData> _regions;
+    std::vector<Node> _nodes;
+    // Tile index to node mapping, -1 for tiles without a node
+    std::vector<int32_t> _tileNodes;
+
+    // Temporary data of the region exploration
+    std::vector<uint32_t> _tileCosts;
+    std::vector<int32_t> _tileFrom;
+    std::vector<int32_t> _exploredTiles;
+    BucketQueue _tilesToExplore;
+
+    bool _isBuildNeeded = true;
+};
+
+// Set of AI pathfinders, one per hero. Paths are cached separately for every hero and re-evaluated in parallel.
+class AIHeroPathfinders
+{
+public:
+    explicit AIHeroPathfinders( const double advantage )
+        : _advantage( advantage )
+    {}
+
+    // Returns the pathfinder of the hero. It has to be re-evaluated before use.
+    AIWorldPathfinder & get( const Heroes & hero );
+
+    // Re-evaluates the pathfinders of all given heroes at once. Pathfinders of other heroes are kept (the instance is shared
+    // between the AI kingdoms), only the pathfinders of the heroes which are no longer on the map are released.
+    void reEvaluateIfNeeded( const std::vector<const Heroes *> & heroes );
+
+    void reset();
+    void invalidateTile( const int tileIndex );
+
+    double getCurrentArmyStrengthMultiplier() const
+    {
+        return _advantage;
+    }
+
+    void setArmyStrengthMultplier( const double multiplier );
+
+private:
+    double _advantage;
+    // Hero ID is used as a key to keep the order of pathfinders the same between runs
+    std::map<int, std::unique_ptr<AIWorldPathfinder>> _pathfinders;
+};
+
+// Calculates the distances from several non-hero armies (like heroes of other kingdoms or castles) to several targets at once.
+// Every army needs a single map evaluation which is reused for all its targets, the armies are evaluated in parallel.
+class AIDistanceMatrix
+{
+public:
+    explicit AIDistanceMatrix( const double advantage )
+        : _advantage( advantage )
+    {}
+
+    // Armies are pairs of tile index and army strength. Only the pairs marked in requiredPairs are calculated. The distances
+    // are returned in the same order (army by army), 0 means that the target cannot be reached or it is not required.
+    std::vector<uint32_t> calculate( const std::vector<std::pair<int, double>> & armies, const std::vector<int> & targets, const std::vector<bool> & requiredPairs,
+                                     const int color );
+
+    void reset();
+    void invalidateTile( const int tileIndex );
+
+private:
+    double _advantage;
+    // Pathfinders are kept between calls to repair the paths of the armies which haven't moved. Every pathfinder belongs to a single
+    // pair of color and army tile index so the distances do not depend on the number of threads which evaluated them.
+    std::map<std::pair<int, int>, std::unique_ptr<AIWorldPathfinder>> _pathfinders;
 };
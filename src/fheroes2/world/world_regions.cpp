@@ -347,4 +347,7 @@ void World::ComputeStaticAnalysis()
             }
         }
     }
+
+    // The region graph has to be re-built for the new regions
+    _regionPathfinder.reset();
 }